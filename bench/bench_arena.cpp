@@ -0,0 +1,63 @@
+// bench_arena.cpp — assn1's pass1() with its tables on the heap (the default
+// memory resource) vs. in a per-assembly std::pmr::monotonic_buffer_resource
+// that is released in one go after each run. Prints runs/sec and the peak
+// RSS of each. Every mode runs in its own child process, so each peak is
+// that mode's alone.
+//
+//   A=../part_1_Main_Syllabus/assn1
+//   g++ -std=c++17 -O2 -pthread bench_arena.cpp $A/pass1.cpp $A/pass2.cpp $A/tables.cpp $A/icfile.cpp $A/inccache.cpp $A/objfile.cpp -o bench_arena
+//   ./bench_arena source.asm [runs]
+
+#include <chrono>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <memory_resource>
+#include <string>
+#include <sys/resource.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#include "../part_1_Main_Syllabus/assn1/assembler.hpp"
+
+using namespace std;
+
+// Runs pass1() `runs` times, each on a fresh context; returns runs/sec
+static double timeRuns(const string& file, int runs, bool arena, size_t& records) {
+    auto t0 = chrono::steady_clock::now();
+    for (int r = 0; r < runs; ++r) {
+        pmr::monotonic_buffer_resource pool;
+        AssemblerData data(arena ? static_cast<pmr::memory_resource*>(&pool) : pmr::get_default_resource());
+        initializeTables(data);
+        if (!pass1(file, data)) { cerr << "Cannot open " << file << "\n"; exit(1); }
+        records = data.intermediateCode.size();
+    }
+    const double s = chrono::duration<double>(chrono::steady_clock::now() - t0).count();
+    return s > 0 ? runs / s : 0.0;
+}
+
+int main(int argc, char** argv) {
+    if (argc < 2) { cerr << "Usage: " << argv[0] << " source.asm [runs]\n"; return 1; }
+    const string file = argv[1];
+    const int runs = argc > 2 ? max(1, atoi(argv[2])) : 20;
+
+    cout << left << setw(24) << "tables in" << setw(14) << "runs/s" << "peak RSS (KiB)\n";
+    for (bool arena : {false, true}) {
+        cout.flush();
+        const pid_t pid = fork();
+        if (pid < 0) { cerr << "fork failed\n"; return 1; }
+        if (pid == 0) {
+            size_t records = 0;
+            const double rate = timeRuns(file, runs, arena, records);
+            cout << setw(24) << (arena ? "monotonic arena" : "heap (default)")
+                 << fixed << setprecision(1) << setw(14) << rate;
+            cout.flush();
+            _exit(0);
+        }
+        int status = 0;
+        struct rusage ru {};
+        wait4(pid, &status, 0, &ru);
+        if (!WIFEXITED(status) || WEXITSTATUS(status) != 0) return 1;
+        cout << ru.ru_maxrss << "\n";   // KiB on Linux
+    }
+    return 0;
+}
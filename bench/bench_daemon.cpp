@@ -0,0 +1,146 @@
+// bench_daemon.cpp — load test for assn1's daemon (`./assembler --serve SOCKET`).
+// C connections each send R requests back to back over the daemon's protocol
+// (see the comment at the top of part_1_Main_Syllabus/assn1/daemon.cpp) and
+// time every round trip. Prints requests/sec and the latency percentiles.
+// With --unique every request's source differs (a trailing comment line with
+// the request number), so the daemon's result cache never hits.
+//
+//   g++ -std=c++17 -O2 -pthread bench_daemon.cpp -o bench_daemon
+//   ./assembler --serve /tmp/asm.sock --threads 0 &
+//   ./bench_daemon /tmp/asm.sock source.asm [--connections C] [--requests R] [--unique]
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+using namespace std;
+
+struct ClientResult {
+    vector<double> latencyUs;
+    size_t ok = 0, failed = 0, hits = 0;
+    string error;
+};
+
+static bool sendAll(int fd, const string& s) {
+    for (size_t off = 0; off < s.size();) {
+        const ssize_t n = send(fd, s.data() + off, s.size() - off, MSG_NOSIGNAL);
+        if (n <= 0) return false;
+        off += (size_t)n;
+    }
+    return true;
+}
+
+// Reads one response: the header line, then the three bodies it announces
+static bool readResponse(int fd, string& buf, string& header) {
+    size_t nl;
+    char chunk[1 << 16];
+    while ((nl = buf.find('\n')) == string::npos) {
+        const ssize_t n = recv(fd, chunk, sizeof chunk, 0);
+        if (n <= 0) return false;
+        buf.append(chunk, (size_t)n);
+    }
+    header.assign(buf, 0, nl);
+    char status[16];
+    unsigned long long a = 0, b = 0, c = 0;
+    if (sscanf(header.c_str(), "%15s %llu %llu %llu", status, &a, &b, &c) != 4) return false;
+    const size_t total = nl + 1 + a + b + c;
+    while (buf.size() < total) {
+        const ssize_t n = recv(fd, chunk, sizeof chunk, 0);
+        if (n <= 0) return false;
+        buf.append(chunk, (size_t)n);
+    }
+    buf.erase(0, total);
+    return true;
+}
+
+static void client(const string& socketPath, const string& source, int id, int requests, bool unique,
+                   ClientResult& r) {
+    sockaddr_un addr{};
+    addr.sun_family = AF_UNIX;
+    strncpy(addr.sun_path, socketPath.c_str(), sizeof addr.sun_path - 1);
+    const int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (fd < 0 || connect(fd, (const sockaddr*)&addr, sizeof addr) != 0) {
+        r.error = "cannot connect to " + socketPath;
+        if (fd >= 0) close(fd);
+        return;
+    }
+    string request, buf, header;
+    r.latencyUs.reserve((size_t)requests);
+    for (int i = 0; i < requests; ++i) {
+        string body = source;
+        if (unique) body += "\n; request " + to_string(id) + "." + to_string(i) + "\n";
+        request = "SOURCE " + to_string(body.size()) + "\n" + body;
+        const auto t0 = chrono::steady_clock::now();
+        if (!sendAll(fd, request) || !readResponse(fd, buf, header)) {
+            r.error = "connection lost";
+            break;
+        }
+        r.latencyUs.push_back(chrono::duration<double, micro>(chrono::steady_clock::now() - t0).count());
+        if (header.compare(0, 3, "OK ") == 0) ++r.ok;
+        else ++r.failed;
+        if (header.size() >= 4 && header.compare(header.size() - 4, 4, " hit") == 0) ++r.hits;
+    }
+    close(fd);
+}
+
+int main(int argc, char** argv) {
+    if (argc < 3) {
+        cerr << "Usage: " << argv[0] << " SOCKET source.asm [--connections C] [--requests R] [--unique]\n";
+        return 1;
+    }
+    const string socketPath = argv[1];
+    int connections = 4, requests = 1000;
+    bool unique = false;
+    for (int i = 3; i < argc; ++i) {
+        const string a = argv[i];
+        if (a == "--connections" && i + 1 < argc) connections = max(1, atoi(argv[++i]));
+        else if (a == "--requests" && i + 1 < argc) requests = max(1, atoi(argv[++i]));
+        else if (a == "--unique") unique = true;
+        else { cerr << "Unknown option " << a << "\n"; return 1; }
+    }
+    ifstream in(argv[2], ios::binary);
+    if (!in) { cerr << "Cannot open " << argv[2] << "\n"; return 1; }
+    ostringstream os;
+    os << in.rdbuf();
+    const string source = os.str();
+
+    vector<ClientResult> results((size_t)connections);
+    vector<thread> threads;
+    const auto t0 = chrono::steady_clock::now();
+    for (int c = 0; c < connections; ++c)
+        threads.emplace_back(client, cref(socketPath), cref(source), c, requests, unique, ref(results[c]));
+    for (thread& t : threads) t.join();
+    const double seconds = chrono::duration<double>(chrono::steady_clock::now() - t0).count();
+
+    vector<double> all;
+    size_t ok = 0, failed = 0, hits = 0;
+    for (const ClientResult& r : results) {
+        if (!r.error.empty()) cerr << "client: " << r.error << "\n";
+        all.insert(all.end(), r.latencyUs.begin(), r.latencyUs.end());
+        ok += r.ok;
+        failed += r.failed;
+        hits += r.hits;
+    }
+    if (all.empty()) return 1;
+    sort(all.begin(), all.end());
+    auto pct = [&all](double p) { return all[min(all.size() - 1, (size_t)(p * all.size()))]; };
+
+    printf("%zu requests over %d connection(s) in %.3f s: %zu ok, %zu failed, %zu cache hits\n",
+           all.size(), connections, seconds, ok, failed, hits);
+    printf("%-16s %12.1f\n", "requests/s", all.size() / seconds);
+    printf("%-16s %12.1f\n", "p50 (us)", pct(0.50));
+    printf("%-16s %12.1f\n", "p99 (us)", pct(0.99));
+    printf("%-16s %12.1f\n", "max (us)", all.back());
+    return failed == 0 && all.size() == (size_t)connections * requests ? 0 : 1;
+}
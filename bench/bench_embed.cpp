@@ -0,0 +1,77 @@
+// bench_embed.cpp — programs/sec of assn1's embedding API (assemble(): source
+// buffer in, listing string out) with one reused AssemblerData, and the heap
+// allocations each run makes. Every operator new is counted; after the first
+// runs have grown the context, a clean program must assemble with none, so
+// the exit status is 1 if any steady-state run allocates. The reused
+// context's listing is also checked against a fresh context's.
+//
+//   A=../part_1_Main_Syllabus/assn1
+//   g++ -std=c++17 -O2 -pthread bench_embed.cpp $A/pass1.cpp $A/pass2.cpp $A/tables.cpp $A/icfile.cpp $A/inccache.cpp $A/objfile.cpp -o bench_embed
+//   ./bench_embed source.asm [runs]
+
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <new>
+#include <sstream>
+#include <string>
+#include "../part_1_Main_Syllabus/assn1/assembler.hpp"
+
+using namespace std;
+
+// ---------- counting allocator ----------
+static atomic<size_t> allocations{0};
+
+void* operator new(size_t n) {
+    allocations.fetch_add(1, memory_order_relaxed);
+    if (void* p = malloc(n ? n : 1)) return p;
+    throw bad_alloc();
+}
+void operator delete(void* p) noexcept { free(p); }
+void operator delete(void* p, size_t) noexcept { free(p); }
+
+int main(int argc, char** argv) {
+    if (argc < 2) { cerr << "Usage: " << argv[0] << " source.asm [runs]\n"; return 1; }
+    const int runs = argc > 2 ? max(3, atoi(argv[2])) : 1000;
+
+    ifstream in(argv[1], ios::binary);
+    if (!in) { cerr << "Cannot open " << argv[1] << "\n"; return 1; }
+    stringstream ss;
+    ss << in.rdbuf();
+    const string source = ss.str();
+
+    // A fresh context per program: the reference listing
+    string expected;
+    {
+        AssemblerData fresh;
+        initializeTables(fresh);
+        if (!assemble(source, fresh, expected))
+            cerr << "note: the program has " << fresh.errors.size() << " errors; their messages allocate\n";
+    }
+
+    AssemblerData ctx;
+    initializeTables(ctx);
+    string listing;
+    size_t first = 0, steady = 0, worst = 0;
+    auto t0 = chrono::steady_clock::now();
+    for (int r = 0; r < runs; ++r) {
+        const size_t before = allocations.load(memory_order_relaxed);
+        assemble(source, ctx, listing);
+        const size_t n = allocations.load(memory_order_relaxed) - before;
+        if (r == 0) first = n;
+        else if (r >= 2) { steady += n; worst = max(worst, n); }  // run 1 may still grow a table
+        if (listing != expected) { cerr << "run " << r << ": listing differs from a fresh context's\n"; return 1; }
+    }
+    const double s = chrono::duration<double>(chrono::steady_clock::now() - t0).count();
+
+    cout << "source: " << source.size() << " bytes, " << ctx.intermediateCode.size() << " IC records, "
+         << listing.size() << " listing bytes\n"
+         << left << setw(34) << "first run" << first << " allocations\n"
+         << setw(34) << "runs 3.." + to_string(runs) << steady << " allocations (worst run " << worst << ")\n"
+         << fixed << setprecision(0)
+         << setw(34) << "reused context" << (s > 0 ? runs / s : 0.0) << " programs/s\n";
+    return steady == 0 ? 0 : 1;
+}
@@ -0,0 +1,136 @@
+// bench_lexer.cpp — lines/sec of the shared string_view lexer against the
+// copying tokenizers it replaced (assn1 processLine and part 2 split_ws_commas).
+//
+//   g++ -std=c++17 -O2 bench_lexer.cpp -o bench_lexer
+//   ./bench_lexer source.asm [repeats]
+
+#include <algorithm>
+#include <cctype>
+#include <chrono>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include "../common/asm_lexer.hpp"
+
+using namespace std;
+
+// ---------- the copying tokenizers, kept verbatim for comparison ----------
+namespace legacy {
+
+string trim(const string& s) {
+    size_t a = s.find_first_not_of(" \t\r\n");
+    if (a == string::npos) return "";
+    size_t b = s.find_last_not_of(" \t\r\n");
+    return s.substr(a, b - a + 1);
+}
+
+vector<string> split(const string& str, char delimiter) {
+    vector<string> tokens; string token; size_t start = 0, end = 0;
+    while ((end = str.find(delimiter, start)) != string::npos) {
+        token = trim(str.substr(start, end - start));
+        if (!token.empty()) tokens.push_back(token);
+        start = end + 1;
+    }
+    token = trim(str.substr(start));
+    if (!token.empty()) tokens.push_back(token);
+    return tokens;
+}
+
+// assn1: comment strip, trim, istringstream, toupper copies, re-join, split(',')
+size_t assn1Line(const string& line) {
+    string clean = line;
+    size_t cpos = clean.find(';');
+    if (cpos != string::npos) clean = clean.substr(0, cpos);
+    clean = trim(clean);
+    if (clean.empty()) return 0;
+    istringstream iss(clean); vector<string> toks; string tok;
+    while (iss >> tok) toks.push_back(tok);
+    string first = toks[0];
+    transform(first.begin(), first.end(), first.begin(), ::toupper);
+    size_t idx = toks.size() > 2 ? 1 : 0;      // stand-in for the MOT label check
+    string mnemonic = toks[idx++];
+    transform(mnemonic.begin(), mnemonic.end(), mnemonic.begin(), ::toupper);
+    size_t n = first.size() + mnemonic.size();
+    if (idx < toks.size()) {
+        string rest;
+        for (size_t i = idx; i < toks.size(); ++i) { rest += toks[i]; if (i + 1 < toks.size()) rest += " "; }
+        for (auto& op : split(rest, ',')) n += op.size();
+    }
+    return n;
+}
+
+// part 2: trim + split_ws_commas into a fresh vector
+size_t part2Line(const string& raw) {
+    string line = trim(raw);
+    if (line.empty()) return 0;
+    vector<string> out; string tok;
+    for (char c : line) {
+        if (c == ',' || isspace((unsigned char)c)) { if (!tok.empty()) { out.push_back(tok); tok.clear(); } }
+        else tok.push_back(c);
+    }
+    if (!tok.empty()) out.push_back(tok);
+    size_t n = 0; for (auto& t : out) n += t.size();
+    return n;
+}
+
+} // namespace legacy
+
+// ---------- the shared lexer, doing the same work ----------
+size_t lexAssn1Line(string_view line) {
+    string_view rest = asmlex::trim(asmlex::stripComment(line, ';'));
+    if (rest.empty()) return 0;
+    string_view first = asmlex::nextToken(rest, false);
+    string_view peek = rest, mnemonic = first;
+    string_view second = asmlex::nextToken(peek, false);
+    if (!second.empty() && !asmlex::nextToken(peek, false).empty()) { mnemonic = second; rest = peek; }
+    size_t n = first.size() + mnemonic.size() + asmlex::iequals(mnemonic, "START");
+    string_view ops[2];
+    int k = asmlex::splitOperands(asmlex::trim(rest), ops, 2);
+    for (int i = 0; i < k; ++i) n += ops[i].size();
+    return n;
+}
+
+size_t lexPart2Line(string_view line) {
+    string_view tok[8];
+    int k = asmlex::tokenize(asmlex::trim(line), tok, 8, true);
+    size_t n = 0; for (int i = 0; i < k; ++i) n += tok[i].size();
+    return n;
+}
+
+template <typename F>
+static double linesPerSec(const vector<string>& lines, int repeats, F&& f, size_t& sink) {
+    auto t0 = chrono::steady_clock::now();
+    for (int r = 0; r < repeats; ++r)
+        for (const auto& l : lines) sink += f(l);
+    double s = chrono::duration<double>(chrono::steady_clock::now() - t0).count();
+    return s > 0 ? double(lines.size()) * repeats / s : 0.0;
+}
+
+int main(int argc, char** argv) {
+    if (argc < 2) { cerr << "Usage: " << argv[0] << " source.asm [repeats]\n"; return 1; }
+    int repeats = argc > 2 ? max(1, atoi(argv[2])) : 5;
+
+    ifstream in(argv[1]);
+    if (!in) { cerr << "Cannot open " << argv[1] << "\n"; return 1; }
+    vector<string> lines; string l;
+    while (getline(in, l)) lines.push_back(l);
+
+    size_t sink = 0;
+    double a1old = linesPerSec(lines, repeats, legacy::assn1Line, sink);
+    double a1new = linesPerSec(lines, repeats, [](const string& s) { return lexAssn1Line(s); }, sink);
+    double p2old = linesPerSec(lines, repeats, legacy::part2Line, sink);
+    double p2new = linesPerSec(lines, repeats, [](const string& s) { return lexPart2Line(s); }, sink);
+
+    cout << fixed << setprecision(0)
+         << "lines: " << lines.size() << " x " << repeats << "  (checksum " << sink << ")\n"
+         << left << setw(34) << "assn1 processLine tokenizer" << a1old << " lines/s\n"
+         << setw(34) << "assn1 string_view lexer" << a1new << " lines/s"
+         << setprecision(2) << "  (" << a1new / a1old << "x)\n" << setprecision(0)
+         << setw(34) << "part 2 split_ws_commas" << p2old << " lines/s\n"
+         << setw(34) << "part 2 string_view lexer" << p2new << " lines/s"
+         << setprecision(2) << "  (" << p2new / p2old << "x)\n";
+    return 0;
+}
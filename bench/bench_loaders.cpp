@@ -0,0 +1,41 @@
+// bench_loaders.cpp — ms/run and lines/sec of assn1's loadPass1Outputs():
+// reading intermediate.txt, symbol_table.txt and literal_table.txt back into
+// an AssemblerData, as `--via-files` does before Pass 2. Write the three files
+// once with `./assembler --emit-intermediate big.asm`.
+//
+//   A=../part_1_Main_Syllabus/assn1
+//   g++ -std=c++17 -O2 -pthread bench_loaders.cpp $A/pass1.cpp $A/pass2.cpp $A/tables.cpp $A/icfile.cpp $A/inccache.cpp $A/objfile.cpp -o bench_loaders
+//   ./bench_loaders intermediate.txt symbol_table.txt literal_table.txt [runs]
+
+#include <chrono>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include "../part_1_Main_Syllabus/assn1/assembler.hpp"
+
+using namespace std;
+
+int main(int argc, char** argv) {
+    if (argc < 4) {
+        cerr << "Usage: " << argv[0] << " intermediate.txt symbol_table.txt literal_table.txt [runs]\n";
+        return 1;
+    }
+    const int runs = argc > 4 ? max(1, atoi(argv[4])) : 5;
+
+    size_t lines = 0;
+    auto t0 = chrono::steady_clock::now();
+    for (int r = 0; r < runs; ++r) {
+        AssemblerData data;
+        initializeTables(data);
+        loadPass1Outputs(argv[1], argv[2], argv[3], data);
+        lines = data.intermediateCode.size() + data.symbolTable.size() + data.literalTable.size();
+    }
+    const double s = chrono::duration<double>(chrono::steady_clock::now() - t0).count();
+
+    cout << "records loaded: " << lines << "\n"
+         << fixed << setprecision(1)
+         << left << setw(24) << "ms/run" << s * 1000 / runs << "\n"
+         << setw(24) << "lines/s" << (s > 0 ? lines * runs / s : 0.0) << "\n";
+    return 0;
+}
@@ -0,0 +1,204 @@
+// bench_phases.cpp — per-phase timings of both assemblers on one source, as
+// JSON on stdout (a readable table goes to stderr), so runs can be diffed and
+// regressions tracked. Each phase is run `runs` times; the median is kept.
+//
+// assn1 is linked in and timed phase by phase: tokenizing (the shared
+// common/asm_lexer.hpp split), lexing (lexSourceLine), pass1(), table
+// emission (text and binary), pass2() from memory, pass2 from the text files,
+// and --one-pass. Part 2's assemblers are separate lab programs, so they are
+// timed as processes in a scratch directory: assignment1 `pass1` (pass 1 +
+// its table files) and assignment2 `pass2`. Build those first; the phases
+// are left out of the JSON if they are missing.
+//
+//   A=../part_1_Main_Syllabus/assn1
+//   g++ -std=c++17 -O2 -pthread bench_phases.cpp $A/pass1.cpp $A/pass2.cpp $A/tables.cpp $A/icfile.cpp $A/inccache.cpp $A/objfile.cpp $A/onepass.cpp -o bench_phases
+//   ./bench_phases source.asm [--runs N] [--part2-pass1 PATH] [--part2-pass2 PATH] > phases.json
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <functional>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <fcntl.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#include "../common/asm_lexer.hpp"
+#include "../common/line_reader.hpp"
+#include "../part_1_Main_Syllabus/assn1/assembler.hpp"
+
+using namespace std;
+namespace fs = std::filesystem;
+
+struct Phase {
+    string assembler, name;
+    double ms;
+};
+
+// Median wall time of `runs` calls, in ms
+static double median(int runs, const function<void()>& f) {
+    vector<double> t;
+    for (int r = 0; r < runs; ++r) {
+        auto t0 = chrono::steady_clock::now();
+        f();
+        t.push_back(chrono::duration<double, milli>(chrono::steady_clock::now() - t0).count());
+    }
+    sort(t.begin(), t.end());
+    return t[t.size() / 2];
+}
+
+// Runs `argv` in `dir` with its output discarded; false if it did not exit 0
+static bool runProcess(const vector<string>& argv, const string& dir) {
+    const pid_t pid = fork();
+    if (pid < 0) return false;
+    if (pid == 0) {
+        if (chdir(dir.c_str()) != 0) _exit(127);
+        const int null = open("/dev/null", O_WRONLY);
+        dup2(null, 1);
+        dup2(null, 2);
+        vector<char*> args;
+        for (const string& a : argv) args.push_back(const_cast<char*>(a.c_str()));
+        args.push_back(nullptr);
+        execv(args[0], args.data());
+        _exit(127);
+    }
+    int status = 0;
+    waitpid(pid, &status, 0);
+    return WIFEXITED(status) && WEXITSTATUS(status) == 0;
+}
+
+static string jsonString(const string& s) {
+    string out = "\"";
+    for (char c : s) {
+        if (c == '"' || c == '\\') out += '\\';
+        out += c;
+    }
+    return out + '"';
+}
+
+int main(int argc, char** argv) {
+    string source, p2pass1 = "../part_2_Sir_syllabus/assignment1/pass1",
+                   p2pass2 = "../part_2_Sir_syllabus/assignment2/pass2";
+    int runs = 5;
+    bool usage = false;
+    for (int i = 1; i < argc; ++i) {
+        const string a = argv[i];
+        if (a == "--runs" && i + 1 < argc) runs = max(1, atoi(argv[++i]));
+        else if (a == "--part2-pass1" && i + 1 < argc) p2pass1 = argv[++i];
+        else if (a == "--part2-pass2" && i + 1 < argc) p2pass2 = argv[++i];
+        else if (source.empty() && a[0] != '-') source = a;
+        else usage = true;
+    }
+    if (usage || source.empty()) {
+        cerr << "Usage: " << argv[0] << " source.asm [--runs N] [--part2-pass1 PATH] [--part2-pass2 PATH]\n";
+        return 2;
+    }
+    error_code ec;
+    const fs::path src = fs::absolute(source, ec);
+    if (!fs::is_regular_file(src, ec)) { cerr << "Cannot open " << source << "\n"; return 1; }
+
+    char tmpl[] = "/tmp/bench_phases.XXXXXX";
+    if (!mkdtemp(tmpl)) { cerr << "Cannot create a scratch directory\n"; return 1; }
+    const fs::path dir = tmpl;
+    const string ic = (dir / "intermediate.txt").string(), st = (dir / "symbol_table.txt").string(),
+                 lt = (dir / "literal_table.txt").string(), bin = (dir / "intermediate.bin").string(),
+                 out = (dir / "output.txt").string();
+
+    // The file-based pass2() reports on std::cout; stdout is kept for the JSON
+    ostringstream chatter;
+    streambuf* const stdoutBuf = cout.rdbuf(chatter.rdbuf());
+
+    vector<Phase> phases;
+    size_t lines = 0, tokens = 0, statements = 0, records = 0;
+
+    // ----- assn1, in process -----
+    phases.push_back({"assn1", "tokenize", median(runs, [&] {
+        LineReader in;
+        in.open(src.string());
+        string_view line, t[8];
+        lines = tokens = 0;
+        while (in.next(line)) {
+            ++lines;
+            tokens += (size_t)asmlex::tokenize(asmlex::stripComment(line, ';'), t, 8, true);
+        }
+    })});
+    AssemblerData tablesOnly;
+    initializeTables(tablesOnly);
+    phases.push_back({"assn1", "lex", median(runs, [&] {
+        LineReader in;
+        in.open(src.string());
+        string_view line;
+        statements = 0;
+        while (in.next(line)) statements += !lexSourceLine(line, tablesOnly).mnemonic.empty();
+    })});
+
+    AssemblerData data;
+    phases.push_back({"assn1", "pass1", median(runs, [&] {
+        data.reset();
+        initializeTables(data);
+        pass1(src.string(), data);
+    })});
+    records = data.intermediateCode.size();
+    if (!data.errors.empty())
+        cerr << "note: " << data.errors.size() << " pass 1 error(s); first: " << data.errors.front() << "\n";
+    phases.push_back({"assn1", "emit_text", median(runs, [&] { writePass1Outputs(data, ic, st, lt); })});
+    phases.push_back({"assn1", "emit_binary", median(runs, [&] { writeBinaryIC(data, bin); })});
+    phases.push_back({"assn1", "pass2", median(runs, [&] { pass2(data, out); })});
+    phases.push_back({"assn1", "pass2_via_files", median(runs, [&] {
+        AssemblerData loaded;
+        initializeTables(loaded);
+        pass2(ic, st, lt, out, loaded);
+    })});
+    phases.push_back({"assn1", "one_pass", median(runs, [&] {
+        AssemblerData d;
+        initializeTables(d);
+        string listing;
+        OnePassStats stats;
+        assembleOnePass(src.string(), d, listing, stats);
+    })});
+
+    cout.rdbuf(stdoutBuf);
+
+    // ----- part 2, as processes -----
+    const string p1 = fs::absolute(p2pass1, ec).string(), p2 = fs::absolute(p2pass2, ec).string();
+    if (access(p1.c_str(), X_OK) == 0 && access(p2.c_str(), X_OK) == 0) {
+        bool ok = true;
+        phases.push_back({"part2", "pass1_process", median(runs, [&] { ok &= runProcess({p1, src.string()}, dir.string()); })});
+        phases.push_back({"part2", "pass2_process", median(runs, [&] { ok &= runProcess({p2}, dir.string()); })});
+        if (!ok) cerr << "note: a part 2 program exited with an error\n";
+    } else {
+        cerr << "note: part 2 programs not found (" << p1 << ", " << p2 << "); build them to time part 2\n";
+    }
+    fs::remove_all(dir, ec);
+
+    // ----- report -----
+    cout << "{\n  \"source\": " << jsonString(src.string()) << ",\n"
+         << "  \"bytes\": " << fs::file_size(src, ec) << ",\n"
+         << "  \"lines\": " << lines << ",\n"
+         << "  \"tokens\": " << tokens << ",\n"
+         << "  \"statements\": " << statements << ",\n"
+         << "  \"ic_records\": " << records << ",\n"
+         << "  \"runs\": " << runs << ",\n"
+         << "  \"phases_ms\": {";
+    string last;
+    for (size_t i = 0; i < phases.size(); ++i) {
+        const Phase& p = phases[i];
+        if (p.assembler != last) {
+            cout << (last.empty() ? "" : "\n    },") << "\n    " << jsonString(p.assembler) << ": {";
+            last = p.assembler;
+        } else {
+            cout << ",";
+        }
+        char v[32];
+        snprintf(v, sizeof v, "%.3f", p.ms);
+        cout << "\n      " << jsonString(p.name) << ": " << v;
+    }
+    cout << (last.empty() ? "" : "\n    }") << "\n  }\n}\n";
+
+    for (const Phase& p : phases) fprintf(stderr, "%-6s %-16s %10.3f ms\n", p.assembler.c_str(), p.name.c_str(), p.ms);
+    return 0;
+}
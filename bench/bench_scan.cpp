@@ -0,0 +1,134 @@
+// bench_scan.cpp — common/simd_scan.hpp vs. the byte-at-a-time asmlex path.
+// For each classifier the CPU supports (scalar, SSE2, AVX2) it times, over
+// the whole file held in memory:
+//   classify   the bitmask pass alone (GB/s)
+//   lines      LineScanner line splitting vs. memchr (lines/sec)
+//   lex        split + strip comment + trim + tokenize every line, from the
+//              bits vs. with asmlex (lines/sec)
+// and checks that both lexers produce the same tokens.
+//
+//   g++ -std=c++17 -O2 bench_scan.cpp -o bench_scan
+//   ./bench_scan source.asm [runs]
+
+#include "../common/simd_scan.hpp"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+template <typename F>
+static double bestMs(int runs, F&& f) {
+    double best = 1e300;
+    for (int r = 0; r < runs; ++r) {
+        const auto t0 = chrono::steady_clock::now();
+        f();
+        best = min(best, chrono::duration<double, milli>(chrono::steady_clock::now() - t0).count());
+    }
+    return best;
+}
+
+static volatile size_t sink;
+
+// memchr line split (what LineReader did before the masks)
+static size_t linesMemchr(const string& text) {
+    size_t n = 0, pos = 0, total = 0;
+    while (pos < text.size()) {
+        const void* nl = memchr(text.data() + pos, '\n', text.size() - pos);
+        const size_t end = nl ? (size_t)(static_cast<const char*>(nl) - text.data()) : text.size();
+        total += end - pos;
+        pos = nl ? end + 1 : text.size();
+        ++n;
+    }
+    sink = total;
+    return n;
+}
+
+static size_t linesMasked(const string& text) {
+    asmscan::LineScanner scan;
+    scan.reset(text.data(), text.size());
+    string_view line;
+    asmscan::LineBits bits;
+    size_t n = 0, total = 0;
+    while (scan.next(line, bits)) {
+        total += line.size();
+        ++n;
+    }
+    sink = total;
+    return n;
+}
+
+// Both lexers: code part of each line, tokens split on blanks and commas
+static size_t lexScalar(const string& text, vector<string_view>* out) {
+    size_t tokens = 0, pos = 0;
+    string_view t[8];
+    while (pos < text.size()) {
+        const void* nl = memchr(text.data() + pos, '\n', text.size() - pos);
+        const size_t end = nl ? (size_t)(static_cast<const char*>(nl) - text.data()) : text.size();
+        const string_view line(text.data() + pos, end - pos);
+        pos = nl ? end + 1 : text.size();
+        const int n = asmlex::tokenize(asmlex::trim(asmlex::stripComment(line, ';')), t, 8, true);
+        tokens += (size_t)n;
+        if (out) out->insert(out->end(), t, t + n);
+    }
+    return tokens;
+}
+
+static size_t lexMasked(const string& text, vector<string_view>* out) {
+    asmscan::LineScanner scan;
+    scan.reset(text.data(), text.size());
+    string_view line, t[8];
+    asmscan::LineBits bits;
+    size_t tokens = 0;
+    while (scan.next(line, bits)) {
+        const int n = bits.valid ? asmscan::tokenize(asmscan::code(line, bits), t, 8, true)
+                                 : asmlex::tokenize(asmlex::trim(asmlex::stripComment(line, ';')), t, 8, true);
+        tokens += (size_t)n;
+        if (out) out->insert(out->end(), t, t + n);
+    }
+    return tokens;
+}
+
+int main(int argc, char** argv) {
+    if (argc < 2) {
+        cerr << "Usage: " << argv[0] << " source.asm [runs]\n";
+        return 1;
+    }
+    const int runs = argc > 2 ? max(1, atoi(argv[2])) : 20;
+    ifstream in(argv[1], ios::binary);
+    if (!in) { cerr << "Cannot open " << argv[1] << "\n"; return 1; }
+    ostringstream os;
+    os << in.rdbuf();
+    const string text = os.str();
+
+    vector<string_view> a, b;
+    lexScalar(text, &a);
+    lexMasked(text, &b);
+    if (a != b) { cerr << "masked and asmlex tokens differ\n"; return 1; }
+    const size_t lines = linesMemchr(text);
+    printf("%s: %zu bytes, %zu lines, %zu tokens, best of %d runs\n\n", argv[1], text.size(), lines, a.size(), runs);
+
+    const double memchrMs = bestMs(runs, [&] { linesMemchr(text); });
+    const double asmlexMs = bestMs(runs, [&] { lexScalar(text, nullptr); });
+    printf("%-8s %14s %18s %18s\n", "", "classify GB/s", "lines Mlines/s", "lex Mlines/s");
+    printf("%-8s %14s %18.1f %18.1f\n", "asmlex", "-", lines / memchrMs / 1e3, lines / asmlexMs / 1e3);
+
+    vector<asmscan::Masks> masks((text.size() + 63) / 64);
+    for (asmscan::Isa isa : {asmscan::Isa::SCALAR, asmscan::Isa::SSE2, asmscan::Isa::AVX2}) {
+        if (!asmscan::setIsa(isa)) continue;
+        const double classifyMs = bestMs(runs, [&] { asmscan::classify(text.data(), text.size(), masks.data()); });
+        const double linesMs = bestMs(runs, [&] { linesMasked(text); });
+        const double lexMs = bestMs(runs, [&] { lexMasked(text, nullptr); });
+        printf("%-8s %14.2f %18.1f %18.1f\n", asmscan::isaName(isa), text.size() / classifyMs / 1e6,
+               lines / linesMs / 1e3, lines / lexMs / 1e3);
+    }
+    asmscan::setIsa(asmscan::bestIsa());
+    printf("\nselected at run time: %s\n", asmscan::isaName(asmscan::activeIsa()));
+    return 0;
+}
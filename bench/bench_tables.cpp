@@ -0,0 +1,116 @@
+// bench_tables.cpp — lookups/sec of the compile-time perfect-hash opcode
+// tables (common/static_table.hpp) against the std::unordered_map tables
+// they replaced, on every whitespace/comma token of a source file (so the
+// mix of hits and misses is realistic: mnemonics, registers, symbols).
+//
+//   g++ -std=c++17 -O2 bench_tables.cpp -o bench_tables
+//   ./bench_tables source.asm [repeats]
+
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "../common/asm_lexer.hpp"
+#include "../common/static_table.hpp"
+
+using namespace std;
+
+struct Op { int opcode; int length; };
+
+// ---------- the runtime-built maps, as initializeTables() used to fill them ----------
+static unordered_map<string, Op> mapMOT = {
+    {"STOP",{0,1}}, {"ADD",{1,1}}, {"SUB",{2,1}}, {"MULT",{3,1}}, {"MOVER",{4,1}}, {"MOVEM",{5,1}},
+    {"COMP",{6,1}}, {"BC",{7,1}}, {"DIV",{8,1}}, {"READ",{9,1}}, {"PRINT",{10,1}},
+    {"DS",{1,0}}, {"DC",{2,1}},
+    {"START",{1,0}}, {"END",{2,0}}, {"ORIGIN",{3,0}}, {"EQU",{4,0}}, {"LTORG",{5,0}},
+};
+static unordered_map<string, int> mapREG = { {"AREG",1}, {"BREG",2}, {"CREG",3}, {"DREG",4} };
+static unordered_map<string, int> mapCC  = { {"LT",1}, {"LE",2}, {"EQ",3}, {"GT",4}, {"GE",5}, {"ANY",6} };
+
+// ---------- the same tables, perfect-hashed at compile time ----------
+static constexpr StaticTable<Op, 18> fastMOT({{
+    {"STOP",{0,1}}, {"ADD",{1,1}}, {"SUB",{2,1}}, {"MULT",{3,1}}, {"MOVER",{4,1}}, {"MOVEM",{5,1}},
+    {"COMP",{6,1}}, {"BC",{7,1}}, {"DIV",{8,1}}, {"READ",{9,1}}, {"PRINT",{10,1}},
+    {"DS",{1,0}}, {"DC",{2,1}},
+    {"START",{1,0}}, {"END",{2,0}}, {"ORIGIN",{3,0}}, {"EQU",{4,0}}, {"LTORG",{5,0}},
+}});
+static constexpr StaticTable<int, 4> fastREG({{ {"AREG",1}, {"BREG",2}, {"CREG",3}, {"DREG",4} }});
+static constexpr StaticTable<int, 6> fastCC({{ {"LT",1}, {"LE",2}, {"EQ",3}, {"GT",4}, {"GE",5}, {"ANY",6} }});
+
+static_assert(fastMOT.findFolded("mover")->opcode == 4, "folded lookups work at compile time too");
+static_assert(fastREG.find("areg") == nullptr, "exact lookups are case-sensitive");
+
+// Each probe looks a token up in all three tables, like pass 1 does for operands
+template <typename T>
+static size_t viaMap(const unordered_map<string, T>& m, const string& key) {
+    auto it = m.find(key);
+    return it == m.end() ? 0 : 1;
+}
+
+// assn1 before: upper-case into a std::string, then hash it per table
+static size_t mapFolded(string_view tok) {
+    char buf[15]; string_view up;
+    if (!asmlex::upperInto(tok, buf, sizeof buf, up)) return 0;
+    string key(up);
+    return viaMap(mapMOT, key) + viaMap(mapREG, key) + viaMap(mapCC, key);
+}
+
+// part 2 before: exact match, one std::string per lookup
+static size_t mapExact(string_view tok) {
+    return viaMap(mapMOT, string(tok)) + viaMap(mapREG, string(tok)) + viaMap(mapCC, string(tok));
+}
+
+static size_t tableFolded(string_view tok) {
+    return (fastMOT.findFolded(tok) != nullptr) + (fastREG.findFolded(tok) != nullptr) +
+           (fastCC.findFolded(tok) != nullptr);
+}
+
+static size_t tableExact(string_view tok) {
+    return (fastMOT.find(tok) != nullptr) + (fastREG.find(tok) != nullptr) + (fastCC.find(tok) != nullptr);
+}
+
+template <typename F>
+static double probesPerSec(const vector<string_view>& toks, int repeats, F&& f, size_t& hits) {
+    auto t0 = chrono::steady_clock::now();
+    for (int r = 0; r < repeats; ++r)
+        for (string_view t : toks) hits += f(t);
+    double s = chrono::duration<double>(chrono::steady_clock::now() - t0).count();
+    return s > 0 ? double(toks.size()) * repeats / s : 0.0;
+}
+
+int main(int argc, char** argv) {
+    if (argc < 2) { cerr << "Usage: " << argv[0] << " source.asm [repeats]\n"; return 1; }
+    int repeats = argc > 2 ? max(1, atoi(argv[2])) : 5;
+
+    ifstream in(argv[1]);
+    if (!in) { cerr << "Cannot open " << argv[1] << "\n"; return 1; }
+    vector<string> lines; string l;
+    while (getline(in, l)) lines.push_back(l);
+    vector<string_view> toks;
+    for (const string& line : lines) {
+        string_view rest = asmlex::stripComment(line, ';');
+        for (string_view t; !(t = asmlex::nextToken(rest, true)).empty();) toks.push_back(t);
+    }
+
+    size_t h1 = 0, h2 = 0, h3 = 0, h4 = 0;
+    double mf = probesPerSec(toks, repeats, mapFolded, h1);
+    double tf = probesPerSec(toks, repeats, tableFolded, h2);
+    double me = probesPerSec(toks, repeats, mapExact, h3);
+    double te = probesPerSec(toks, repeats, tableExact, h4);
+    if (h1 != h2 || h3 != h4) { cerr << "hit counts differ\n"; return 1; }
+
+    cout << fixed << setprecision(0)
+         << "tokens: " << toks.size() << " x " << repeats << "  (3 tables per token, "
+         << h1 / repeats << " folded / " << h3 / repeats << " exact hits per pass)\n"
+         << left << setw(34) << "unordered_map, upper-cased key" << mf << " tokens/s\n"
+         << setw(34) << "StaticTable::findFolded" << tf << " tokens/s"
+         << setprecision(2) << "  (" << tf / mf << "x)\n" << setprecision(0)
+         << setw(34) << "unordered_map, exact key" << me << " tokens/s\n"
+         << setw(34) << "StaticTable::find" << te << " tokens/s"
+         << setprecision(2) << "  (" << te / me << "x)\n";
+    return 0;
+}
@@ -0,0 +1,173 @@
+// gen_workload.cpp — writes a synthetic source program for the benchmarks.
+// The output is valid for both assemblers (assn1 and part 2 assignment1): the
+// same instruction set, upper-case mnemonics, no comments. Every referenced
+// symbol is defined exactly once, EQUs never form cycles, and ORIGIN only
+// moves forward from the location counter the generator tracks itself.
+//
+//   g++ -std=c++17 -O2 gen_workload.cpp -o gen_workload
+//   ./gen_workload [options] > big.asm
+//
+//   --lines N      statements between START and END        (default 100000)
+//   --symbols N    labels defined, EQUs included            (default lines/5)
+//   --forward F    fraction of symbol references that are forward (0..1, default 0.3)
+//   --literals F   fraction of register instructions with a literal operand (default 0.2)
+//   --ltorg N      an LTORG every N statements, 0 = only at END (default 500)
+//   --origin F     fraction of statements that are ORIGIN   (default 0.001)
+//   --equ F        fraction of statements that are EQU      (default 0.02)
+//   --ds F         fraction of statements that are DS       (default 0.05)
+//   --ds-max N     DS sizes are uniform in [1, N]           (default 5)
+//   --seed N       random seed                              (default 1)
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <string>
+#include <unordered_set>
+#include <vector>
+
+using namespace std;
+
+struct Options {
+    long lines = 100000;
+    long symbols = -1;
+    double forward = 0.3, literals = 0.2, origin = 0.001, equ = 0.02, ds = 0.05;
+    long ltorg = 500, dsMax = 5;
+    unsigned seed = 1;
+};
+
+enum class Kind : uint8_t { IS, DC, DS, EQU, LTORG, ORIGIN };
+
+static bool parseArgs(int argc, char** argv, Options& o) {
+    for (int i = 1; i < argc; ++i) {
+        const string a = argv[i];
+        if (i + 1 >= argc) return false;
+        const char* v = argv[++i];
+        if (a == "--lines") o.lines = atol(v);
+        else if (a == "--symbols") o.symbols = atol(v);
+        else if (a == "--forward") o.forward = atof(v);
+        else if (a == "--literals") o.literals = atof(v);
+        else if (a == "--ltorg") o.ltorg = atol(v);
+        else if (a == "--origin") o.origin = atof(v);
+        else if (a == "--equ") o.equ = atof(v);
+        else if (a == "--ds") o.ds = atof(v);
+        else if (a == "--ds-max") o.dsMax = atol(v);
+        else if (a == "--seed") o.seed = (unsigned)atol(v);
+        else return false;
+    }
+    if (o.symbols < 0) o.symbols = o.lines / 5;
+    return o.lines > 0 && o.dsMax > 0 && o.ltorg >= 0;
+}
+
+int main(int argc, char** argv) {
+    Options o;
+    if (!parseArgs(argc, argv, o)) {
+        fprintf(stderr, "Usage: %s [--lines N] [--symbols N] [--forward F] [--literals F] [--ltorg N]\n"
+                        "          [--origin F] [--equ F] [--ds F] [--ds-max N] [--seed N]\n", argv[0]);
+        return 2;
+    }
+    mt19937_64 rng(o.seed);
+    uniform_real_distribution<double> coin(0.0, 1.0);
+    auto pick = [&rng](long n) { return (long)(rng() % (uint64_t)n); };
+
+    // 1. Statement kinds; every EQU is labeled, so EQUs are capped by the symbol budget
+    vector<Kind> kind((size_t)o.lines, Kind::IS);
+    long equs = 0;
+    for (long i = 0; i < o.lines; ++i) {
+        if (o.ltorg > 0 && i % o.ltorg == o.ltorg - 1) { kind[i] = Kind::LTORG; continue; }
+        const double r = coin(rng);
+        if (r < o.origin) kind[i] = Kind::ORIGIN;
+        else if (r < o.origin + o.equ && equs < o.symbols) { kind[i] = Kind::EQU; ++equs; }
+        else if (r < o.origin + o.equ + o.ds) kind[i] = Kind::DS;
+        else if (r < o.origin + o.equ + o.ds + 0.05) kind[i] = Kind::DC;
+    }
+
+    // 2. Label positions: the EQUs plus a random sample of IS/DC/DS statements.
+    //    Label k is the k-th one defined, so "forward" is just k >= defined-so-far.
+    vector<long> eligible;
+    for (long i = 0; i < o.lines; ++i)
+        if (kind[i] == Kind::IS || kind[i] == Kind::DC || kind[i] == Kind::DS) eligible.push_back(i);
+    const long others = min<long>((long)eligible.size(), max(0L, o.symbols - equs));
+    for (long i = 0; i < others; ++i) swap(eligible[i], eligible[i + pick((long)eligible.size() - i)]);
+    vector<char> labeled((size_t)o.lines, 0);
+    for (long i = 0; i < others; ++i) labeled[eligible[i]] = 1;
+    for (long i = 0; i < o.lines; ++i) if (kind[i] == Kind::EQU) labeled[i] = 1;
+    vector<char> isEqu;   // by label number
+    for (long i = 0; i < o.lines; ++i) if (labeled[i]) isEqu.push_back(kind[i] == Kind::EQU);
+    const long labels = (long)isEqu.size();
+
+    // A label for a reference made when `defined` labels exist; EQUs may only
+    // point at non-EQU labels (no cycles). -1 if there is none to pick.
+    auto reference = [&](long defined, bool fromEqu) -> long {
+        const bool fwd = defined < labels && (defined == 0 || coin(rng) < o.forward);
+        const long lo = fwd ? defined : 0, hi = fwd ? labels : defined;
+        if (hi <= lo) return -1;
+        long k = lo + pick(hi - lo);
+        if (!fromEqu) return k;
+        for (long n = 0; n < hi - lo; ++n, k = (k + 1 < hi) ? k + 1 : lo)
+            if (!isEqu[k]) return k;
+        return -1;
+    };
+
+    static const char* const ops[] = {"ADD", "SUB", "MULT", "MOVER", "MOVEM", "COMP", "DIV"};
+    static const char* const regs[] = {"AREG", "BREG", "CREG", "DREG"};
+    static const char* const ccs[] = {"LT", "LE", "EQ", "GT", "GE", "ANY"};
+
+    string out;
+    out.reserve((size_t)o.lines * 20);
+    char line[128];
+    auto emit = [&out, &line](int n) { out.append(line, (size_t)n); };
+
+    long long lc = 100;
+    unordered_set<string> pool;   // distinct literal texts of the current pool
+    auto placePool = [&]() { lc += (long long)pool.size(); pool.clear(); };
+    out += "START 100\n";
+
+    long defined = 0;
+    for (long i = 0; i < o.lines; ++i) {
+        char label[24] = "";
+        if (labeled[i]) snprintf(label, sizeof label, "L%ld ", defined);
+        const Kind k = kind[i];
+        if (k == Kind::LTORG) {
+            emit(snprintf(line, sizeof line, "LTORG\n"));
+            placePool();
+        } else if (k == Kind::ORIGIN) {
+            lc += pick(64);
+            emit(snprintf(line, sizeof line, "ORIGIN %lld\n", lc));
+        } else if (k == Kind::EQU) {
+            const long target = reference(defined, true);
+            if (target < 0) emit(snprintf(line, sizeof line, "%sEQU %ld\n", label, 100 + pick(1000)));
+            else emit(snprintf(line, sizeof line, "%sEQU L%ld+%ld\n", label, target, pick(8)));
+        } else if (k == Kind::DS) {
+            const long n = 1 + pick(o.dsMax);
+            emit(snprintf(line, sizeof line, "%sDS %ld\n", label, n));
+            lc += n;
+        } else if (k == Kind::DC) {
+            emit(snprintf(line, sizeof line, "%sDC %ld\n", label, pick(1000)));
+            ++lc;
+        } else {
+            const long target = reference(defined, false);
+            const double r = coin(rng);
+            if (target < 0 || r < 0.02) {
+                emit(snprintf(line, sizeof line, "%sSTOP\n", label));
+            } else if (r < 0.1) {
+                emit(snprintf(line, sizeof line, "%sBC %s, L%ld\n", label, ccs[pick(6)], target));
+            } else if (r < 0.15) {
+                emit(snprintf(line, sizeof line, "%s%s L%ld\n", label, pick(2) ? "READ" : "PRINT", target));
+            } else if (coin(rng) < o.literals) {
+                char lit[16];
+                snprintf(lit, sizeof lit, pick(4) ? "=%ld" : "='%ld'", pick(50));
+                pool.insert(lit);
+                emit(snprintf(line, sizeof line, "%s%s %s, %s\n", label, ops[pick(7)], regs[pick(4)], lit));
+            } else {
+                emit(snprintf(line, sizeof line, "%s%s %s, L%ld\n", label, ops[pick(7)], regs[pick(4)], target));
+            }
+            ++lc;
+        }
+        if (labeled[i]) ++defined;
+    }
+    out += "END\n";
+    fwrite(out.data(), 1, out.size(), stdout);
+    return 0;
+}
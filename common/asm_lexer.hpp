@@ -0,0 +1,95 @@
+#pragma once
+// Single-pass, zero-copy lexer for assembler source lines.
+// Every token is a std::string_view into the caller's line buffer, so the
+// buffer must outlive the tokens. Case-insensitive matching compares in place.
+#include <charconv>
+#include <cstddef>
+#include <string_view>
+#include <system_error>
+
+namespace asmlex {
+
+inline bool isSpace(char c) { return c == ' ' || c == '\t' || c == '\r' || c == '\n' || c == '\v' || c == '\f'; }
+
+inline char toUpper(char c) { return (c >= 'a' && c <= 'z') ? char(c - 'a' + 'A') : c; }
+
+// ASCII case-insensitive equality, no copies
+inline bool iequals(std::string_view a, std::string_view b) {
+    if (a.size() != b.size()) return false;
+    for (std::size_t i = 0; i < a.size(); ++i)
+        if (toUpper(a[i]) != toUpper(b[i])) return false;
+    return true;
+}
+
+// Upper-cases `s` into `buf` (capacity `cap`); returns false if it does not fit.
+// Used to build short lookup keys on the stack instead of heap strings.
+inline bool upperInto(std::string_view s, char* buf, std::size_t cap, std::string_view& out) {
+    if (s.size() > cap) return false;
+    for (std::size_t i = 0; i < s.size(); ++i) buf[i] = toUpper(s[i]);
+    out = std::string_view(buf, s.size());
+    return true;
+}
+
+inline std::string_view trim(std::string_view s) {
+    std::size_t a = 0, b = s.size();
+    while (a < b && isSpace(s[a])) ++a;
+    while (b > a && isSpace(s[b - 1])) --b;
+    return s.substr(a, b - a);
+}
+
+// Everything before the first `comment` character
+inline std::string_view stripComment(std::string_view s, char comment) {
+    std::size_t p = s.find(comment);
+    return p == std::string_view::npos ? s : s.substr(0, p);
+}
+
+// Pops the next token off the front of `s`. Tokens end at whitespace, and
+// also at ',' when `commas` is set. Returns an empty view when `s` runs out.
+inline std::string_view nextToken(std::string_view& s, bool commas) {
+    std::size_t i = 0, n = s.size();
+    while (i < n && (isSpace(s[i]) || (commas && s[i] == ','))) ++i;
+    std::size_t j = i;
+    while (j < n && !isSpace(s[j]) && !(commas && s[j] == ',')) ++j;
+    std::string_view tok = s.substr(i, j - i);
+    s.remove_prefix(j);
+    return tok;
+}
+
+// Splits `s` into at most `max` tokens; returns the number written to `out`
+inline int tokenize(std::string_view s, std::string_view* out, int max, bool commas) {
+    int n = 0;
+    while (n < max) {
+        std::string_view t = nextToken(s, commas);
+        if (t.empty()) break;
+        out[n++] = t;
+    }
+    return n;
+}
+
+// Splits an operand field on ',' into trimmed, non-empty operands
+inline int splitOperands(std::string_view s, std::string_view* out, int max) {
+    int n = 0;
+    while (n < max) {
+        std::size_t c = s.find(',');
+        std::string_view op = trim(s.substr(0, c));
+        if (!op.empty()) out[n++] = op;
+        if (c == std::string_view::npos) break;
+        s.remove_prefix(c + 1);
+    }
+    return n;
+}
+
+// Parses all of `t` (optional sign, no blanks) as an integer with
+// std::from_chars: no locale, no exceptions. Returns std::errc() on success,
+// invalid_argument if `t` is not an integer, result_out_of_range if it does
+// not fit T; `out` is only written on success.
+template <typename T>
+inline std::errc parseInt(std::string_view t, T& out) {
+    if (!t.empty() && t[0] == '+') t.remove_prefix(1);   // from_chars takes '-' but not '+'
+    if (t.empty()) return std::errc::invalid_argument;
+    auto r = std::from_chars(t.data(), t.data() + t.size(), out);
+    if (r.ec != std::errc()) return r.ec;
+    return r.ptr == t.data() + t.size() ? std::errc() : std::errc::invalid_argument;
+}
+
+} // namespace asmlex
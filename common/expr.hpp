@@ -0,0 +1,358 @@
+#pragma once
+// Expression engine for directive operands (START, ORIGIN, EQU, DS).
+// An operand is compiled once into postfix code over integer constants and
+// symbol IDs with + - * /, unary minus and parentheses. Constant parts are
+// folded while compiling: "4*2+1" becomes one constant, "BUF+4*2" becomes
+// BUF 8 +. Evaluation gets symbol values from the caller and stops at the
+// first symbol that has none yet, so the caller can defer the expression
+// until that symbol is defined (see DeferredList / resolve below).
+#include <charconv>
+#include <cstddef>
+#include <cstdint>
+#include <memory_resource>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <vector>
+#include "asm_lexer.hpp"
+
+namespace asmexpr {
+
+enum class Op : std::uint8_t { CONST, SYMBOL, ADD, SUB, MUL, DIV, NEG };
+
+struct Instr {
+    Op op;
+    std::int64_t value;     // CONST: the value, SYMBOL: the symbol ID
+};
+
+struct Expr {
+    std::vector<Instr> code;
+    std::uint32_t depth = 0;   // evaluation stack needed
+
+    bool isConstant() const { return code.size() == 1 && code[0].op == Op::CONST; }
+};
+
+enum class Status : std::uint8_t {
+    OK,
+    UNDEFINED,        // `symbol` has no value yet
+    DIVIDE_BY_ZERO,
+    OUT_OF_RANGE      // an intermediate result left int64
+};
+
+struct Result {
+    Status status = Status::OK;
+    std::int64_t value = 0;
+    std::uint32_t symbol = 0;
+};
+
+// A whole operand that is just a decimal integer (optional sign, surrounding
+// blanks); the common case, taken without compiling anything
+inline bool parseInteger(std::string_view s, std::int64_t& out) {
+    return asmlex::parseInt(asmlex::trim(s), out) == std::errc();
+}
+
+// a op b; false (with `status` set) on division by zero or overflow
+inline bool apply(Op op, std::int64_t a, std::int64_t b, std::int64_t& out, Status& status) {
+    bool overflow = false;
+    switch (op) {
+    case Op::ADD: overflow = __builtin_add_overflow(a, b, &out); break;
+    case Op::SUB: overflow = __builtin_sub_overflow(a, b, &out); break;
+    case Op::MUL: overflow = __builtin_mul_overflow(a, b, &out); break;
+    case Op::NEG: overflow = __builtin_sub_overflow(std::int64_t(0), a, &out); break;
+    case Op::DIV:
+        if (b == 0) { status = Status::DIVIDE_BY_ZERO; return false; }
+        if (a == INT64_MIN && b == -1) overflow = true;
+        else out = a / b;   // truncates toward zero
+        break;
+    default: break;
+    }
+    if (overflow) { status = Status::OUT_OF_RANGE; return false; }
+    return true;
+}
+
+// Recursive descent over one operand:
+//   expr   := term (('+' | '-') term)*
+//   term   := unary (('*' | '/') unary)*
+//   unary  := ('+' | '-') unary | number | symbol | '(' expr ')'
+// A symbol is any run of characters other than blanks, operators and parentheses.
+template <typename Intern>
+class Compiler {
+public:
+    Compiler(std::string_view text, Intern& intern, Expr& out) : s_(text), intern_(intern), out_(out) {}
+
+    bool run(std::string& error) {
+        out_.code.clear();
+        out_.depth = 0;
+        if (!expr(0)) { error = error_; return false; }
+        skipSpace();
+        if (pos_ < s_.size()) { error = "unexpected '" + std::string(1, s_[pos_]) + "'"; return false; }
+        return true;
+    }
+
+private:
+    static constexpr int kMaxNesting = 64;
+
+    static bool isDelimiter(char c) {
+        return asmlex::isSpace(c) || c == '+' || c == '-' || c == '*' || c == '/' || c == '(' || c == ')';
+    }
+    void skipSpace() { while (pos_ < s_.size() && asmlex::isSpace(s_[pos_])) ++pos_; }
+    bool peek(char c) { skipSpace(); return pos_ < s_.size() && s_[pos_] == c; }
+    bool fail(std::string msg) { error_ = std::move(msg); return false; }
+
+    void push(Instr i) {
+        out_.code.push_back(i);
+        if (++height_ > out_.depth) out_.depth = height_;
+    }
+
+    // Emits a unary/binary operator, folding it when its operands are constants
+    void emit(Op op) {
+        std::vector<Instr>& c = out_.code;
+        const size_t n = c.size();
+        Status st;
+        std::int64_t v;
+        if (op == Op::NEG) {
+            if (c[n - 1].op == Op::CONST && apply(op, c[n - 1].value, 0, v, st)) { c[n - 1].value = v; return; }
+            c.push_back({op, 0});
+            return;
+        }
+        --height_;
+        // In postfix code a CONST right before the operand that follows it is that whole operand
+        if (c[n - 1].op == Op::CONST && c[n - 2].op == Op::CONST &&
+            apply(op, c[n - 2].value, c[n - 1].value, v, st)) {
+            c.pop_back();
+            c.back().value = v;
+            return;
+        }
+        c.push_back({op, 0});
+    }
+
+    bool expr(int nesting) {
+        if (nesting > kMaxNesting) return fail("nested too deeply");
+        if (!term(nesting)) return false;
+        while (peek('+') || peek('-')) {
+            const Op op = s_[pos_++] == '+' ? Op::ADD : Op::SUB;
+            if (!term(nesting)) return false;
+            emit(op);
+        }
+        return true;
+    }
+
+    bool term(int nesting) {
+        if (!unary(nesting)) return false;
+        while (peek('*') || peek('/')) {
+            const Op op = s_[pos_++] == '*' ? Op::MUL : Op::DIV;
+            if (!unary(nesting)) return false;
+            emit(op);
+        }
+        return true;
+    }
+
+    bool unary(int nesting) {
+        if (nesting > kMaxNesting) return fail("nested too deeply");
+        skipSpace();
+        if (pos_ == s_.size()) return fail("missing operand");
+        const char c = s_[pos_];
+        if (c == '+' || c == '-') {
+            ++pos_;
+            if (!unary(nesting + 1)) return false;
+            if (c == '-') emit(Op::NEG);
+            return true;
+        }
+        if (c == '(') {
+            ++pos_;
+            if (!expr(nesting + 1)) return false;
+            if (!peek(')')) return fail("missing ')'");
+            ++pos_;
+            return true;
+        }
+        size_t end = pos_;
+        while (end < s_.size() && !isDelimiter(s_[end])) ++end;
+        if (end == pos_) return fail("unexpected '" + std::string(1, c) + "'");
+        const std::string_view token = s_.substr(pos_, end - pos_);
+        pos_ = end;
+        if (c >= '0' && c <= '9') {
+            std::int64_t v = 0;
+            auto r = std::from_chars(token.data(), token.data() + token.size(), v);
+            if (r.ec != std::errc() || r.ptr != token.data() + token.size())
+                return fail("bad number '" + std::string(token) + "'");
+            push({Op::CONST, v});
+        } else {
+            push({Op::SYMBOL, (std::int64_t)intern_(token)});
+        }
+        return true;
+    }
+
+    std::string_view s_;
+    size_t pos_ = 0;
+    Intern& intern_;
+    Expr& out_;
+    std::uint32_t height_ = 0;
+    std::string error_;
+};
+
+// Compiles `text` into `out`; `intern(name)` gives a symbol's ID.
+// Returns false with `error` set if the text is not an expression.
+template <typename Intern>
+bool compile(std::string_view text, Intern&& intern, Expr& out, std::string& error) {
+    return Compiler<std::remove_reference_t<Intern>>(text, intern, out).run(error);
+}
+
+// Evaluates code[0, count) needing `depth` stack slots; `value(id, v)` stores
+// symbol id's value in v and returns false if it has none yet
+template <typename Value>
+Result evaluate(const Instr* code, size_t count, std::uint32_t depth, Value&& value) {
+    std::int64_t small[16];
+    std::vector<std::int64_t> large;
+    std::int64_t* st = small;
+    if (depth > 16) { large.resize(depth); st = large.data(); }
+
+    Result r;
+    size_t n = 0;
+    for (const Instr* i = code; i != code + count; ++i) {
+        switch (i->op) {
+        case Op::CONST:
+            st[n++] = i->value;
+            break;
+        case Op::SYMBOL:
+            if (!value((std::uint32_t)i->value, st[n])) {
+                r.status = Status::UNDEFINED;
+                r.symbol = (std::uint32_t)i->value;
+                return r;
+            }
+            ++n;
+            break;
+        case Op::NEG:
+            if (!apply(i->op, st[n - 1], 0, st[n - 1], r.status)) return r;
+            break;
+        default:
+            if (!apply(i->op, st[n - 2], st[n - 1], st[n - 2], r.status)) return r;
+            --n;
+            break;
+        }
+    }
+    r.value = n ? st[0] : 0;
+    return r;
+}
+
+template <typename Value>
+Result evaluate(const Expr& e, Value&& value) {
+    return evaluate(e.code.data(), e.code.size(), e.depth, value);
+}
+
+// Whether code[0, count) is absolute, i.e. its value does not move when the
+// program is loaded elsewhere. `absolute(id)` tells which symbols are; every
+// other symbol carries the load address once. + and - add and subtract those
+// counts and unary minus negates them, so the result is absolute when they
+// cancel (END_BUF - BUF). A product or quotient with a relocatable term is
+// not a plain address either way; it is reported as relocatable.
+template <typename Absolute>
+bool isAbsolute(const Instr* code, size_t count, std::uint32_t depth, Absolute&& absolute) {
+    std::int64_t small[16];
+    std::vector<std::int64_t> large;
+    std::int64_t* st = small;   // per stack slot: times the load address is in it
+    if (depth > 16) { large.resize(depth); st = large.data(); }
+
+    size_t n = 0;
+    for (const Instr* i = code; i != code + count; ++i) {
+        switch (i->op) {
+        case Op::CONST:  st[n++] = 0; break;
+        case Op::SYMBOL: st[n++] = absolute((std::uint32_t)i->value) ? 0 : 1; break;
+        case Op::NEG:    st[n - 1] = -st[n - 1]; break;
+        case Op::ADD:    st[n - 2] += st[n - 1]; --n; break;
+        case Op::SUB:    st[n - 2] -= st[n - 1]; --n; break;
+        default:         // MUL, DIV
+            if (st[n - 2] != 0 || st[n - 1] != 0) return false;
+            --n;
+            break;
+        }
+    }
+    return n == 0 || st[0] == 0;
+}
+
+template <typename Absolute>
+bool isAbsolute(const Expr& e, Absolute&& absolute) {
+    return isAbsolute(e.code.data(), e.code.size(), e.depth, absolute);
+}
+
+// Why a result is not a value, for error messages; `name(id)` gives a symbol's name
+template <typename Name>
+std::string describe(const Result& r, Name&& name) {
+    switch (r.status) {
+    case Status::UNDEFINED:      return "uses undefined symbol '" + std::string(name(r.symbol)) + "'";
+    case Status::DIVIDE_BY_ZERO: return "divides by zero";
+    case Status::OUT_OF_RANGE:   return "overflows";
+    default:                     return "";
+    }
+}
+
+// Definitions (EQUs) whose expressions use symbols that are not defined yet.
+// Each keeps its compiled code, so it is parsed once and evaluated once it
+// can be. The code of all of them shares one pool, and clear() keeps every
+// vector's capacity, so a reused list stops allocating once it has grown.
+// Its vectors come from `mr` (the heap by default).
+struct DeferredList {
+    struct Entry {
+        std::uint32_t symbol;      // the symbol it defines
+        std::int32_t line;         // source line, for errors
+        std::uint32_t begin, end;  // its code: code[begin, end)
+        std::uint32_t depth;
+        bool active;               // on the resolution stack (a dependency back to it is a cycle)
+    };
+    std::pmr::vector<Entry> entries;
+    std::pmr::vector<Instr> code;
+    std::pmr::vector<int> stack;   // resolve()'s work stack
+
+    explicit DeferredList(std::pmr::memory_resource* mr = std::pmr::get_default_resource())
+        : entries(mr), code(mr), stack(mr) {}
+
+    int add(std::uint32_t symbol, std::int32_t line, const Expr& e) {
+        const std::uint32_t begin = (std::uint32_t)code.size();
+        code.insert(code.end(), e.code.begin(), e.code.end());
+        entries.push_back(Entry{symbol, line, begin, (std::uint32_t)code.size(), e.depth, false});
+        return (int)entries.size() - 1;
+    }
+    size_t size() const { return entries.size(); }
+    const Entry& operator[](size_t i) const { return entries[i]; }
+    void clear() { entries.clear(); code.clear(); stack.clear(); }
+};
+
+// Resolves list[index], first resolving the deferred definitions its
+// expression waits on: depth first with an explicit stack, so definitions
+// settle in dependency (topological) order and long chains cannot exhaust
+// the call stack.
+//   value(id, v)  -> bool   symbol id's value, if it has one
+//   pending(id)   -> int    index of id's deferred definition, or -1
+//   settle(i, r)            list[i] is done: r is its value, or an error no
+//                           later line can fix (UNDEFINED with pending(r.symbol)
+//                           >= 0 is a cycle). Must leave pending(its symbol) -1.
+// Unless `final`, a definition waiting on a symbol that may still be defined
+// by a later line stays deferred.
+template <typename Value, typename Pending, typename Settle>
+void resolve(DeferredList& list, int index, bool final, Value&& value, Pending&& pending, Settle&& settle) {
+    std::pmr::vector<int>& stack = list.stack;
+    stack.assign(1, index);
+    list.entries[index].active = true;
+    while (!stack.empty()) {
+        const int top = stack.back();
+        const DeferredList::Entry& q = list.entries[top];
+        const Result r = evaluate(list.code.data() + q.begin, q.end - q.begin, q.depth, value);
+        if (r.status == Status::UNDEFINED) {
+            const int dep = pending(r.symbol);
+            if (dep >= 0 && !list.entries[dep].active) {
+                list.entries[dep].active = true;
+                stack.push_back(dep);
+                continue;
+            }
+            if (dep < 0 && !final) {
+                for (int i : stack) list.entries[i].active = false;
+                stack.clear();
+                return;
+            }
+        }
+        stack.pop_back();
+        list.entries[top].active = false;
+        settle(top, r);
+    }
+}
+
+} // namespace asmexpr
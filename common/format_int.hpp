@@ -0,0 +1,16 @@
+#pragma once
+// Allocation-free integer formatting for the machine-code writers.
+// appendInt(out, v, w) produces exactly what `os << std::setw(w) <<
+// std::setfill('0') << v` would (right-aligned, fill before any '-' sign),
+// without touching stream state, so worker threads can format into their
+// own buffers.
+#include <charconv>
+#include <string>
+
+inline void appendInt(std::string& out, long long v, int width = 0) {
+    char buf[24];
+    auto r = std::to_chars(buf, buf + sizeof buf, v);
+    int len = (int)(r.ptr - buf);
+    if (len < width) out.append((std::size_t)(width - len), '0');
+    out.append(buf, (std::size_t)len);
+}
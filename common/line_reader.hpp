@@ -0,0 +1,89 @@
+#pragma once
+// Line-at-a-time source input for the assemblers.
+// Regular files are memory-mapped and walked newline to newline, so a line is
+// just a view into the mapping (files larger than RAM are fine). Pipes and
+// stdin ("-") fall back to a growable read buffer. Lines are returned without
+// the '\n'; a view stays valid until the next call to next().
+// Newlines are found from the vectorized class masks of simd_scan.hpp, and
+// next(line, bits) also hands back the line's whitespace/comma/';' bits.
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "mapped_file.hpp"
+#include "simd_scan.hpp"
+
+class LineReader {
+public:
+    LineReader() = default;
+    ~LineReader() { if (file_ && file_ != stdin) std::fclose(file_); }
+    LineReader(const LineReader&) = delete;
+    LineReader& operator=(const LineReader&) = delete;
+
+    bool open(const std::string& path) {
+        lineNumber_ = 0;
+        if (path != "-" && map_.open(path)) {
+            scan_.reset(map_.data(), map_.size());
+            return true;
+        }
+        file_ = (path == "-") ? stdin : std::fopen(path.c_str(), "rb");
+        if (!file_) return false;
+        buf_.resize(1 << 20);
+        begin_ = end_ = 0;
+        eof_ = false;
+        scan_.reset(buf_.data(), 0, false);
+        return true;
+    }
+
+    bool next(std::string_view& line) {
+        asmscan::LineBits bits;
+        return next(line, bits);
+    }
+
+    // Also returns the line's class bits (bits.valid is false past 64 bytes)
+    bool next(std::string_view& line, asmscan::LineBits& bits) {
+        if (!file_) {
+            if (!scan_.next(line, bits)) return false;
+            ++lineNumber_;
+            return true;
+        }
+        return nextBuffered(line, bits);
+    }
+
+    // 1-based number of the line last returned by next()
+    std::int64_t lineNumber() const { return lineNumber_; }
+    bool mapped() const { return file_ == nullptr; }
+
+private:
+    bool nextBuffered(std::string_view& line, asmscan::LineBits& bits) {
+        for (;;) {
+            if (scan_.next(line, bits)) {   // at EOF this includes a last line without '\n'
+                ++lineNumber_;
+                return true;
+            }
+            if (eof_) return false;
+            // keep the partial line, then refill (growing if one line fills the buffer)
+            begin_ += scan_.consumed();
+            std::memmove(buf_.data(), buf_.data() + begin_, end_ - begin_);
+            end_ -= begin_;
+            begin_ = 0;
+            if (end_ == buf_.size()) buf_.resize(buf_.size() * 2);
+            std::size_t got = std::fread(buf_.data() + end_, 1, buf_.size() - end_, file_);
+            if (got == 0) eof_ = true;
+            end_ += got;
+            scan_.reset(buf_.data(), end_, eof_);
+        }
+    }
+
+    MappedFile map_;
+    asmscan::LineScanner scan_;
+
+    std::FILE* file_ = nullptr;
+    std::vector<char> buf_;
+    std::size_t begin_ = 0, end_ = 0;
+    bool eof_ = false;
+
+    std::int64_t lineNumber_ = 0;
+};
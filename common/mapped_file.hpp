@@ -0,0 +1,63 @@
+#pragma once
+// Read-only memory mapping of a whole file (POSIX). Shared by the assemblers.
+#include <cstddef>
+#include <string>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+class MappedFile {
+public:
+    MappedFile() = default;
+    explicit MappedFile(const std::string& path) { open(path); }
+    ~MappedFile() { close(); }
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+    MappedFile(MappedFile&& o) noexcept : data_(o.data_), size_(o.size_), ok_(o.ok_) {
+        o.data_ = nullptr; o.size_ = 0; o.ok_ = false;
+    }
+    MappedFile& operator=(MappedFile&& o) noexcept {
+        if (this != &o) {
+            close();
+            data_ = o.data_; size_ = o.size_; ok_ = o.ok_;
+            o.data_ = nullptr; o.size_ = 0; o.ok_ = false;
+        }
+        return *this;
+    }
+
+    // Maps `path`; returns false if it cannot be opened or is not a regular file
+    // (pipes, terminals, ...), in which case the caller should fall back to reads.
+    bool open(const std::string& path) {
+        close();
+        int fd = ::open(path.c_str(), O_RDONLY);
+        if (fd < 0) return false;
+        struct stat st;
+        if (::fstat(fd, &st) != 0 || !S_ISREG(st.st_mode)) { ::close(fd); return false; }
+        size_ = (std::size_t)st.st_size;
+        if (size_ > 0) {
+            void* p = ::mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, fd, 0);
+            if (p == MAP_FAILED) { ::close(fd); size_ = 0; return false; }
+            ::madvise(p, size_, MADV_SEQUENTIAL);
+            data_ = static_cast<const char*>(p);
+        }
+        ::close(fd);
+        ok_ = true;
+        return true;
+    }
+
+    void close() {
+        if (data_) ::munmap(const_cast<char*>(data_), size_);
+        data_ = nullptr; size_ = 0; ok_ = false;
+    }
+
+    bool isOpen() const { return ok_; }
+    const char* data() const { return data_; }
+    std::size_t size() const { return size_; }
+
+private:
+    const char* data_ = nullptr;
+    std::size_t size_ = 0;
+    bool ok_ = false;
+};
@@ -0,0 +1,365 @@
+#pragma once
+// Vectorized byte classification for the assembler lexers.
+// A buffer is classified 64 bytes at a time into bitmasks, bit i = byte i:
+// newlines, whitespace (asmlex::isSpace), ',' and ';'. LineScanner splits a
+// buffer into lines from the newline masks and hands each line its own
+// whitespace/comma/comment bits, and the MaskedText functions below trim,
+// strip comments, tokenize and split operands from those bits with ctz/clz
+// instead of walking bytes. They return exactly what the asmlex functions of
+// the same name return.
+//
+// The classifier is picked at run time from the CPU: AVX2 (two 32-byte
+// compares per block), SSE2 (four 16-byte ones; always present on x86-64) or
+// a portable scalar loop. setIsa() forces one (benchmarks); -DASM_NO_SIMD
+// builds the scalar loop only. Lines over 64 bytes get no bits
+// (LineBits::valid is false) and are lexed with asmlex instead.
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string_view>
+#include "asm_lexer.hpp"
+
+#if !defined(ASM_NO_SIMD) && (defined(__x86_64__) || defined(__i386__)) && (defined(__GNUC__) || defined(__clang__))
+#define ASM_SCAN_X86 1
+#include <immintrin.h>
+#endif
+
+namespace asmscan {
+
+// One 64-byte block of a buffer
+struct Masks {
+    std::uint64_t newline = 0;   // '\n'
+    std::uint64_t space = 0;     // ' ' and '\t' .. '\r' (newline included)
+    std::uint64_t comma = 0;     // ','
+    std::uint64_t comment = 0;   // ';'
+};
+
+enum class Isa : std::uint8_t { SCALAR, SSE2, AVX2 };
+
+inline const char* isaName(Isa isa) {
+    switch (isa) {
+        case Isa::AVX2: return "avx2";
+        case Isa::SSE2: return "sse2";
+        default:        return "scalar";
+    }
+}
+
+namespace detail {
+// 0x80 in every byte of w equal to c, 0 elsewhere
+inline std::uint64_t bytesEqual(std::uint64_t w, unsigned char c) {
+    const std::uint64_t x = w ^ (0x0101010101010101ull * c), low7 = 0x7F7F7F7F7F7F7F7Full;
+    return ~(((x & low7) + low7) | x | low7);
+}
+
+// The 8 byte flags (0x80) of bytesEqual as 8 bits
+inline std::uint64_t gatherBits(std::uint64_t flags) { return ((flags >> 7) * 0x0102040810204080ull) >> 56; }
+} // namespace detail
+
+// Classifies `blocks` full blocks at p (64 * blocks readable bytes), eight
+// bytes per step (SWAR)
+inline void classifyScalar(const char* p, std::size_t blocks, Masks* out) {
+    using detail::bytesEqual;
+    using detail::gatherBits;
+    for (std::size_t b = 0; b < blocks; ++b, p += 64) {
+        Masks m;
+        for (unsigned k = 0; k < 8; ++k) {
+            std::uint64_t w;
+            std::memcpy(&w, p + 8 * k, 8);
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+            w = __builtin_bswap64(w);   // byte 0 in the low bits
+#endif
+            const std::uint64_t nl = bytesEqual(w, '\n');
+            const std::uint64_t ws = nl | bytesEqual(w, ' ') | bytesEqual(w, '\t') | bytesEqual(w, '\v') |
+                                     bytesEqual(w, '\f') | bytesEqual(w, '\r');
+            const unsigned shift = 8 * k;
+            m.newline |= gatherBits(nl) << shift;
+            m.space |= gatherBits(ws) << shift;
+            m.comma |= gatherBits(bytesEqual(w, ',')) << shift;
+            m.comment |= gatherBits(bytesEqual(w, ';')) << shift;
+        }
+        out[b] = m;
+    }
+}
+
+#ifdef ASM_SCAN_X86
+inline void classifySse2(const char* p, std::size_t blocks, Masks* out) {
+    const __m128i nl = _mm_set1_epi8('\n'), sp = _mm_set1_epi8(' '), cm = _mm_set1_epi8(','),
+                  sc = _mm_set1_epi8(';'), tab = _mm_set1_epi8('\t'), ctlSpan = _mm_set1_epi8('\r' - '\t');
+    for (std::size_t b = 0; b < blocks; ++b, p += 64) {
+        Masks m;
+        for (unsigned k = 0; k < 4; ++k) {
+            const __m128i x = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p + 16 * k));
+            const __m128i t = _mm_sub_epi8(x, tab);   // '\t'..'\r' -> 0..4, unsigned
+            const __m128i ws = _mm_or_si128(_mm_cmpeq_epi8(_mm_min_epu8(t, ctlSpan), t), _mm_cmpeq_epi8(x, sp));
+            const unsigned shift = 16 * k;
+            m.newline |= std::uint64_t((unsigned)_mm_movemask_epi8(_mm_cmpeq_epi8(x, nl))) << shift;
+            m.space |= std::uint64_t((unsigned)_mm_movemask_epi8(ws)) << shift;
+            m.comma |= std::uint64_t((unsigned)_mm_movemask_epi8(_mm_cmpeq_epi8(x, cm))) << shift;
+            m.comment |= std::uint64_t((unsigned)_mm_movemask_epi8(_mm_cmpeq_epi8(x, sc))) << shift;
+        }
+        out[b] = m;
+    }
+}
+
+__attribute__((target("avx2"))) inline void classifyAvx2(const char* p, std::size_t blocks, Masks* out) {
+    const __m256i nl = _mm256_set1_epi8('\n'), sp = _mm256_set1_epi8(' '), cm = _mm256_set1_epi8(','),
+                  sc = _mm256_set1_epi8(';'), tab = _mm256_set1_epi8('\t'), ctlSpan = _mm256_set1_epi8('\r' - '\t');
+    for (std::size_t b = 0; b < blocks; ++b, p += 64) {
+        Masks m;
+        for (unsigned k = 0; k < 2; ++k) {
+            const __m256i x = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p + 32 * k));
+            const __m256i t = _mm256_sub_epi8(x, tab);
+            const __m256i ws =
+                _mm256_or_si256(_mm256_cmpeq_epi8(_mm256_min_epu8(t, ctlSpan), t), _mm256_cmpeq_epi8(x, sp));
+            const unsigned shift = 32 * k;
+            m.newline |= std::uint64_t((std::uint32_t)_mm256_movemask_epi8(_mm256_cmpeq_epi8(x, nl))) << shift;
+            m.space |= std::uint64_t((std::uint32_t)_mm256_movemask_epi8(ws)) << shift;
+            m.comma |= std::uint64_t((std::uint32_t)_mm256_movemask_epi8(_mm256_cmpeq_epi8(x, cm))) << shift;
+            m.comment |= std::uint64_t((std::uint32_t)_mm256_movemask_epi8(_mm256_cmpeq_epi8(x, sc))) << shift;
+        }
+        out[b] = m;
+    }
+}
+#endif
+
+inline bool supported(Isa isa) {
+#ifdef ASM_SCAN_X86
+    if (isa == Isa::AVX2) return __builtin_cpu_supports("avx2");
+    if (isa == Isa::SSE2) return __builtin_cpu_supports("sse2");
+#endif
+    return isa == Isa::SCALAR;
+}
+
+inline Isa bestIsa() {
+    if (supported(Isa::AVX2)) return Isa::AVX2;
+    if (supported(Isa::SSE2)) return Isa::SSE2;
+    return Isa::SCALAR;
+}
+
+using ClassifyFn = void (*)(const char*, std::size_t, Masks*);
+
+namespace detail {
+struct Dispatch {
+    Isa isa;
+    ClassifyFn fn;
+};
+
+inline ClassifyFn classifierFor(Isa isa) {
+#ifdef ASM_SCAN_X86
+    if (isa == Isa::AVX2) return classifyAvx2;
+    if (isa == Isa::SSE2) return classifySse2;
+#endif
+    (void)isa;
+    return classifyScalar;
+}
+
+inline Dispatch& dispatch() {
+    static Dispatch d{bestIsa(), classifierFor(bestIsa())};
+    return d;
+}
+} // namespace detail
+
+inline Isa activeIsa() { return detail::dispatch().isa; }
+
+// Forces a classifier; returns false (and changes nothing) if the CPU lacks it.
+// Not thread-safe: call before any scanning starts.
+inline bool setIsa(Isa isa) {
+    if (!supported(isa)) return false;
+    detail::dispatch() = {isa, detail::classifierFor(isa)};
+    return true;
+}
+
+// Classifies n bytes at p into (n + 63) / 64 blocks; the bits past n are 0
+inline void classify(const char* p, std::size_t n, Masks* out) {
+    const std::size_t full = n / 64;
+    detail::dispatch().fn(p, full, out);
+    if (n % 64) {
+        char tail[64] = {};
+        std::memcpy(tail, p + full * 64, n % 64);
+        detail::dispatch().fn(tail, 1, out + full);
+    }
+}
+
+// ---------------------------------------------------------------------------
+// Lines and their bits
+// ---------------------------------------------------------------------------
+
+inline std::uint64_t lowBits(std::size_t n) { return n >= 64 ? ~std::uint64_t(0) : (std::uint64_t(1) << n) - 1; }
+inline std::uint64_t shiftDown(std::uint64_t x, std::size_t n) { return n >= 64 ? 0 : x >> n; }
+
+// Class bits of one line, bit i = line[i]
+struct LineBits {
+    std::uint64_t space = 0, comma = 0, comment = 0;
+    bool valid = false;   // false: the line is over 64 bytes, lex it with asmlex
+};
+
+// Splits a buffer into lines ('\n' removed), classifying it a window of
+// blocks at a time as it goes. The buffer must outlive the lines.
+class LineScanner {
+public:
+    // `final`: the buffer ends the input, so a last line without '\n' counts
+    void reset(const char* data, std::size_t size, bool final = true) {
+        data_ = data;
+        size_ = size;
+        final_ = final;
+        pos_ = first_ = count_ = 0;
+        block_ = 0;
+        cur_ = Masks{};
+        if (size_) load(0);
+        newlines_ = cur_.newline;
+    }
+
+    // Next complete line and its bits; false at the end of the buffer (or,
+    // unless final, when only an unterminated line is left)
+    bool next(std::string_view& line, LineBits& bits) {
+        if (pos_ >= size_) return false;
+        if (pos_ >= (block_ + 1) * 64) advance();   // the last line ended its block
+        const std::size_t start = pos_;
+        const Masks first = cur_;
+        std::size_t end;
+        for (;;) {
+            if (newlines_) {
+                end = block_ * 64 + (std::size_t)__builtin_ctzll(newlines_);
+                newlines_ &= newlines_ - 1;
+                break;
+            }
+            if ((block_ + 1) * 64 >= size_) {
+                if (!final_) return false;
+                end = size_;
+                break;
+            }
+            advance();
+        }
+        line = std::string_view(data_ + start, end - start);
+        bits = lineBits(first, start, end - start);
+        pos_ = end < size_ ? end + 1 : size_;
+        return true;
+    }
+
+    // Bytes of the buffer taken by the lines returned so far
+    std::size_t consumed() const { return pos_; }
+
+private:
+    static constexpr std::size_t WINDOW = 128;   // blocks classified per refill (8 KiB of text)
+
+    void load(std::size_t b) {
+        if (b - first_ >= count_) {
+            first_ = b;
+            const std::size_t bytes = std::min(size_ - b * 64, WINDOW * 64);
+            classify(data_ + b * 64, bytes, window_);
+            count_ = (bytes + 63) / 64;
+        }
+        block_ = b;
+        cur_ = window_[b - first_];
+    }
+
+    void advance() {
+        load(block_ + 1);
+        newlines_ = cur_.newline;
+    }
+
+    // A line of up to 64 bytes starts in `first` and, if it crosses into the
+    // next block, ends in cur_
+    LineBits lineBits(const Masks& first, std::size_t at, std::size_t len) const {
+        LineBits r;
+        if (len > 64) return r;
+        const std::size_t shift = at % 64;
+        r.space = first.space >> shift;
+        r.comma = first.comma >> shift;
+        r.comment = first.comment >> shift;
+        if (shift + len > 64) {
+            r.space |= cur_.space << (64 - shift);
+            r.comma |= cur_.comma << (64 - shift);
+            r.comment |= cur_.comment << (64 - shift);
+        }
+        const std::uint64_t mask = lowBits(len);
+        r.space &= mask;
+        r.comma &= mask;
+        r.comment &= mask;
+        r.valid = true;
+        return r;
+    }
+
+    const char* data_ = nullptr;
+    std::size_t size_ = 0, pos_ = 0;
+    bool final_ = true;
+    std::size_t block_ = 0;          // block holding pos_ (or the line being scanned)
+    Masks cur_;                      // its masks
+    std::uint64_t newlines_ = 0;     // its newlines not yet returned
+    std::size_t first_ = 0, count_ = 0;   // window_ holds blocks [first_, first_ + count_)
+    Masks window_[WINDOW];
+};
+
+// ---------------------------------------------------------------------------
+// Lexing from the bits (mirrors asm_lexer.hpp)
+// ---------------------------------------------------------------------------
+
+// A piece of a line with its whitespace and comma bits, bit 0 = text[0]
+struct MaskedText {
+    std::string_view text;
+    std::uint64_t space = 0, comma = 0;
+};
+
+// The bytes from n on (n <= size)
+inline MaskedText dropPrefix(const MaskedText& t, std::size_t n) {
+    return {std::string_view(t.text.data() + n, t.text.size() - n), shiftDown(t.space, n), shiftDown(t.comma, n)};
+}
+
+// The first n bytes (n <= size)
+inline MaskedText prefix(const MaskedText& t, std::size_t n) {
+    return {std::string_view(t.text.data(), n), t.space & lowBits(n), t.comma & lowBits(n)};
+}
+
+inline MaskedText trim(const MaskedText& t) {
+    const std::uint64_t solid = ~t.space & lowBits(t.text.size());
+    if (!solid) return {std::string_view(t.text.data() + t.text.size(), 0), 0, 0};
+    const std::size_t a = (std::size_t)__builtin_ctzll(solid), b = 64 - (std::size_t)__builtin_clzll(solid);
+    return {std::string_view(t.text.data() + a, b - a), (t.space >> a) & lowBits(b - a), (t.comma >> a) & lowBits(b - a)};
+}
+
+// asmlex::trim(asmlex::stripComment(line, ';')) for a line with valid bits
+inline MaskedText code(std::string_view line, const LineBits& bits) {
+    const std::size_t end = bits.comment ? (std::size_t)__builtin_ctzll(bits.comment) : line.size();
+    return trim(prefix(MaskedText{line, bits.space, bits.comma}, end));
+}
+
+inline std::string_view nextToken(MaskedText& t, bool commas) {
+    const std::size_t n = t.text.size();
+    const std::uint64_t delim = t.space | (commas ? t.comma : 0);   // bits past n are 0
+    const std::uint64_t solid = ~delim & lowBits(n);
+    if (!solid) {
+        t = {std::string_view(t.text.data() + n, 0), 0, 0};
+        return t.text;
+    }
+    const std::size_t i = (std::size_t)__builtin_ctzll(solid);
+    const std::uint64_t after = delim >> i;
+    const std::size_t j = after ? i + (std::size_t)__builtin_ctzll(after) : n;
+    const std::string_view tok(t.text.data() + i, j - i);
+    t = dropPrefix(t, j);
+    return tok;
+}
+
+inline int tokenize(MaskedText t, std::string_view* out, int max, bool commas) {
+    int n = 0;
+    while (n < max) {
+        std::string_view tok = nextToken(t, commas);
+        if (tok.empty()) break;
+        out[n++] = tok;
+    }
+    return n;
+}
+
+inline int splitOperands(MaskedText t, std::string_view* out, int max) {
+    int n = 0;
+    while (n < max) {
+        const std::size_t c = t.comma ? (std::size_t)__builtin_ctzll(t.comma) : t.text.size();
+        const MaskedText op = trim(prefix(t, c));
+        if (!op.text.empty()) out[n++] = op.text;
+        if (c == t.text.size()) break;
+        t = dropPrefix(t, c + 1);
+    }
+    return n;
+}
+
+} // namespace asmscan
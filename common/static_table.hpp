@@ -0,0 +1,84 @@
+#pragma once
+// Compile-time perfect-hash table for small fixed keyword sets (mnemonics,
+// registers, condition codes). The constructor searches for a hash seed that
+// puts every key in its own slot; declared `constexpr`, that search runs in
+// the compiler, so the table needs no runtime initialization. A lookup takes a
+// string_view, never allocates, and costs one hash plus one key compare.
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+
+template <typename V, std::size_t N>
+class StaticTable {
+public:
+    struct Entry {
+        std::string_view key;
+        V value;
+    };
+
+    constexpr StaticTable(const Entry (&entries)[N]) {
+        for (std::size_t i = 0; i < N; ++i) {
+            entries_[i] = entries[i];
+            if (entries[i].key.size() > maxLen_) maxLen_ = entries[i].key.size();
+        }
+        for (seed_ = 1; !place(seed_); ++seed_) {}
+    }
+
+    // Exact match
+    constexpr const V* find(std::string_view key) const { return lookup<false>(key); }
+
+    // ASCII case-insensitive match; the table's own keys must be upper-case
+    constexpr const V* findFolded(std::string_view key) const { return lookup<true>(key); }
+
+    static constexpr std::size_t size() { return N; }
+
+private:
+    static constexpr std::size_t slotCount() {
+        std::size_t n = 1;
+        while (n < 2 * N) n <<= 1;
+        return n;
+    }
+    static constexpr std::size_t kSlots = slotCount();
+
+    static constexpr char upper(char c) { return (c >= 'a' && c <= 'z') ? char(c - 'a' + 'A') : c; }
+
+    template <bool Fold>
+    static constexpr std::uint32_t hash(std::string_view s, std::uint32_t seed) {
+        std::uint32_t h = seed ^ ((std::uint32_t)s.size() * 0x9E3779B1u);
+        for (char c : s) {
+            h ^= (unsigned char)(Fold ? upper(c) : c);
+            h *= 16777619u;
+        }
+        return h ^ (h >> 16);
+    }
+
+    // Fills slots_ for `seed`; false if two keys collide
+    constexpr bool place(std::uint32_t seed) {
+        for (std::size_t i = 0; i < kSlots; ++i) slots_[i] = 0;
+        for (std::size_t i = 0; i < N; ++i) {
+            std::uint8_t& s = slots_[hash<false>(entries_[i].key, seed) & (kSlots - 1)];
+            if (s) return false;
+            s = (std::uint8_t)(i + 1);
+        }
+        return true;
+    }
+
+    template <bool Fold>
+    constexpr const V* lookup(std::string_view key) const {
+        if (key.size() > maxLen_) return nullptr;
+        const std::uint8_t s = slots_[hash<Fold>(key, seed_) & (kSlots - 1)];
+        if (!s) return nullptr;
+        const Entry& e = entries_[s - 1];
+        if (e.key.size() != key.size()) return nullptr;
+        for (std::size_t i = 0; i < key.size(); ++i)
+            if ((Fold ? upper(key[i]) : key[i]) != e.key[i]) return nullptr;
+        return &e.value;
+    }
+
+    static_assert(N > 0 && N < 255, "slot indices are stored in one byte");
+
+    Entry entries_[N]{};
+    std::uint8_t slots_[kSlots]{};    // entry index + 1, 0 = empty
+    std::size_t maxLen_ = 0;
+    std::uint32_t seed_ = 0;
+};
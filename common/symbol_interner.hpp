@@ -0,0 +1,124 @@
+#pragma once
+// Symbol interner shared by the assemblers: each distinct name gets a dense
+// integer ID (0, 1, 2, ... in first-seen order) exactly once. Lookups go
+// through an open-addressing hash table (linear probing, power-of-two size,
+// load factor <= 1/2); names live back to back in one character pool.
+// All three buffers come from one memory resource (the heap by default), so
+// an interner can live in a caller's arena.
+#include <cstdint>
+#include <cstddef>
+#include <memory_resource>
+#include <string>
+#include <string_view>
+#include <vector>
+
+class SymbolInterner {
+public:
+    static constexpr std::uint32_t npos = ~0u;
+
+    explicit SymbolInterner(std::pmr::memory_resource* mr = std::pmr::get_default_resource())
+        : slots_(mr), pool_(mr), offsets_(1, 0, mr) {}
+
+    // ID of `name`, adding it if it has not been seen yet
+    std::uint32_t intern(std::string_view name) {
+        if ((count() + 1) * 2 > slots_.size()) grow();
+        const std::uint32_t h = hash(name);
+        std::size_t mask = slots_.size() - 1;
+        for (std::size_t i = h & mask;; i = (i + 1) & mask) {
+            Slot& s = slots_[i];
+            if (s.id == npos) {
+                s.hash = h;
+                s.id = (std::uint32_t)count();
+                offsets_.push_back((std::uint32_t)(pool_.size() + name.size()));
+                pool_.append(name.data(), name.size());
+                return s.id;
+            }
+            if (s.hash == h && this->name(s.id) == name) return s.id;
+        }
+    }
+
+    // ID of `name`, or npos if it was never interned
+    std::uint32_t find(std::string_view name) const {
+        if (slots_.empty()) return npos;
+        const std::uint32_t h = hash(name);
+        std::size_t mask = slots_.size() - 1;
+        for (std::size_t i = h & mask;; i = (i + 1) & mask) {
+            const Slot& s = slots_[i];
+            if (s.id == npos) return npos;
+            if (s.hash == h && this->name(s.id) == name) return s.id;
+        }
+    }
+
+    // Valid until the next intern() call
+    std::string_view name(std::uint32_t id) const {
+        return std::string_view(pool_.data() + offsets_[id], offsets_[id + 1] - offsets_[id]);
+    }
+
+    std::size_t size() const { return count(); }
+
+    // Forget every name but keep the allocated capacity
+    void clear() {
+        pool_.clear();
+        offsets_.assign(1, 0);
+        for (Slot& s : slots_) s.id = npos;
+    }
+
+    void reserve(std::size_t names) {
+        std::size_t want = 16;
+        while (want < names * 2) want <<= 1;
+        if (want > slots_.size()) rehash(want);
+        offsets_.reserve(names + 1);
+    }
+
+    // Probe lengths of a successful lookup, from each name's distance to its
+    // home slot; computed on demand, so lookups themselves count nothing
+    struct ProbeStats {
+        std::size_t names = 0, slots = 0;
+        double meanProbes = 0;
+        std::size_t maxProbes = 0;
+    };
+    ProbeStats probeStats() const {
+        ProbeStats p;
+        p.names = count();
+        p.slots = slots_.size();
+        const std::size_t mask = slots_.size() - 1;
+        std::size_t total = 0;
+        for (std::size_t i = 0; i < slots_.size(); ++i) {
+            if (slots_[i].id == npos) continue;
+            const std::size_t probes = ((i - slots_[i].hash) & mask) + 1;
+            total += probes;
+            if (probes > p.maxProbes) p.maxProbes = probes;
+        }
+        if (p.names) p.meanProbes = (double)total / (double)p.names;
+        return p;
+    }
+
+    static std::uint32_t hash(std::string_view s) {
+        std::uint32_t h = 2166136261u;            // FNV-1a
+        for (unsigned char c : s) { h ^= c; h *= 16777619u; }
+        return h;
+    }
+
+private:
+    struct Slot { std::uint32_t hash = 0; std::uint32_t id = npos; };
+
+    std::size_t count() const { return offsets_.size() - 1; }
+
+    void grow() { rehash(slots_.empty() ? 16 : slots_.size() * 2); }
+
+    void rehash(std::size_t capacity) {
+        std::pmr::vector<Slot> old(capacity, slots_.get_allocator());
+        old.swap(slots_);
+        std::size_t mask = capacity - 1;
+        for (const Slot& s : old) {
+            if (s.id == npos) continue;
+            std::size_t i = s.hash & mask;
+            while (slots_[i].id != npos) i = (i + 1) & mask;
+            slots_[i] = s;
+        }
+    }
+
+    std::pmr::vector<Slot> slots_;
+    std::pmr::string pool_;
+    std::pmr::vector<std::uint32_t> offsets_;   // name i = pool_[offsets_[i], offsets_[i+1])
+};
@@ -0,0 +1,141 @@
+#pragma once
+// Fixed-size thread pool used by the assemblers for data-parallel loops.
+// parallelFor(n, f) runs f(0..n-1) across the workers plus the calling
+// thread, handing out indices one at a time, and returns when all are done.
+// stealingFor(n, f) does the same for coarse, uneven jobs (whole files): each
+// thread owns a contiguous block of indices and steals from the others once
+// its own block runs dry.
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+class ThreadPool {
+public:
+    // `threads` counts the calling thread too, so ThreadPool(1) starts no workers
+    explicit ThreadPool(unsigned threads) {
+        threads = std::max(1u, threads);
+        for (unsigned i = 1; i < threads; ++i) workers_.emplace_back([this] { workerLoop(); });
+    }
+
+    ~ThreadPool() {
+        {
+            std::lock_guard<std::mutex> lk(m_);
+            stop_ = true;
+        }
+        cv_.notify_all();
+        for (auto& t : workers_) t.join();
+    }
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    unsigned size() const { return (unsigned)workers_.size() + 1; }
+
+    template <typename F>
+    void parallelFor(std::size_t count, F&& f) {
+        if (count == 0) return;
+        if (workers_.empty() || count == 1) {
+            for (std::size_t i = 0; i < count; ++i) f(i);
+            return;
+        }
+        std::atomic<std::size_t> next{0};
+        std::function<void()> body = [&] {
+            for (std::size_t i; (i = next.fetch_add(1)) < count;) f(i);
+        };
+        run(body);
+    }
+
+    template <typename F>
+    void stealingFor(std::size_t count, F&& f) {
+        if (count == 0) return;
+        if (workers_.empty() || count == 1) {
+            for (std::size_t i = 0; i < count; ++i) f(i);
+            return;
+        }
+        const unsigned n = size();
+        std::vector<StealQueue> queues(n);
+        for (unsigned q = 0; q < n; ++q)
+            for (std::size_t i = count * q / n; i < count * (q + 1) / n; ++i) queues[q].items.push_back(i);
+
+        std::atomic<unsigned> ticket{0};
+        std::function<void()> body = [&] {
+            const unsigned self = ticket.fetch_add(1);
+            std::size_t i;
+            for (;;) {
+                if (queues[self].popFront(i)) { f(i); continue; }
+                bool stole = false;
+                for (unsigned k = 1; k < n && !stole; ++k) stole = queues[(self + k) % n].popBack(i);
+                if (!stole) return;     // every queue is empty; nothing is ever re-queued
+                f(i);
+            }
+        };
+        run(body);
+    }
+
+private:
+    // Owner takes from the front (in order), thieves from the back
+    struct StealQueue {
+        std::mutex m;
+        std::deque<std::size_t> items;
+        bool popFront(std::size_t& i) {
+            std::lock_guard<std::mutex> lk(m);
+            if (items.empty()) return false;
+            i = items.front(); items.pop_front();
+            return true;
+        }
+        bool popBack(std::size_t& i) {
+            std::lock_guard<std::mutex> lk(m);
+            if (items.empty()) return false;
+            i = items.back(); items.pop_back();
+            return true;
+        }
+    };
+
+    // Runs `body` on every worker and the calling thread; returns when all finish
+    void run(std::function<void()>& body) {
+        {
+            std::lock_guard<std::mutex> lk(m_);
+            job_ = &body;
+            active_ = (unsigned)workers_.size();
+            ++generation_;
+        }
+        cv_.notify_all();
+        body();
+        std::unique_lock<std::mutex> lk(m_);
+        done_.wait(lk, [this] { return active_ == 0; });
+        job_ = nullptr;
+    }
+
+    void workerLoop() {
+        unsigned long seen = 0;
+        for (;;) {
+            std::function<void()>* job;
+            {
+                std::unique_lock<std::mutex> lk(m_);
+                cv_.wait(lk, [&] { return stop_ || generation_ != seen; });
+                if (stop_) return;
+                seen = generation_;
+                job = job_;
+            }
+            (*job)();
+            {
+                std::lock_guard<std::mutex> lk(m_);
+                if (--active_ == 0) done_.notify_one();
+            }
+        }
+    }
+
+    std::vector<std::thread> workers_;
+    std::mutex m_;
+    std::condition_variable cv_, done_;
+    std::function<void()>* job_ = nullptr;
+    unsigned long generation_ = 0;
+    unsigned active_ = 0;
+    bool stop_ = false;
+};
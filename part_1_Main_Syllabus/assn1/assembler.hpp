@@ -1,69 +1,223 @@
 #pragma once
+#include <cstdint>
+#include <memory_resource>
 #include <string>
+#include <string_view>
 #include <vector>
-#include <map>
-#include <unordered_map>
+#include "../../common/expr.hpp"
+#include "../../common/simd_scan.hpp"
+#include "../../common/static_table.hpp"
+#include "../../common/symbol_interner.hpp"
 
 enum class InstructionType { IMPERATIVE, DECLARATIVE, ASSEMBLER };
 
+// Word addresses are unsigned 32-bit. The all-ones value marks a literal that
+// has no address yet, so words occupy [0, ADDRESS_END).
+using Address = std::uint32_t;
+constexpr Address NO_ADDRESS = 0xFFFFFFFFu;
+constexpr std::int64_t ADDRESS_END = NO_ADDRESS;
+
+// How the text tables and displays show an address (-1 for NO_ADDRESS, as before)
+inline long long printedAddress(Address a) { return a == NO_ADDRESS ? -1 : (long long)a; }
+
 struct Instruction {
-    std::string mnemonic;
+    std::string_view mnemonic;
     int opcode;
     int length;
     InstructionType type;
-    Instruction() : opcode(-1), length(0), type(InstructionType::IMPERATIVE) {}
-    Instruction(const std::string& mn, int op, int len, InstructionType t)
+    constexpr Instruction() : opcode(-1), length(0), type(InstructionType::IMPERATIVE) {}
+    constexpr Instruction(std::string_view mn, int op, int len, InstructionType t)
         : mnemonic(mn), opcode(op), length(len), type(t) {}
 };
 
+// Indexed by symbol ID; the name lives in AssemblerData::symbolIds.
+// A referenced but not yet defined symbol (forward reference) has address 0
+// and `defined` false; 0 is also a valid address for a defined one.
+// Labels are relocatable; an EQU is absolute when its value does not depend
+// on where the program is loaded (a constant, or labels that cancel out), and
+// then it is neither relocated in the object file nor moved by the loader.
 struct SymbolTableEntry {
-    std::string symbol;
-    int address;
+    Address address;
     int length;
-    SymbolTableEntry() : address(0), length(1) {}
-    SymbolTableEntry(const std::string& sym, int addr, int len = 1)
-        : symbol(sym), address(addr), length(len) {}
+    bool defined;
+    bool absolute;
+    std::int32_t equ;   // index into AssemblerData::deferredEqus while its EQU waits, else -1
+    SymbolTableEntry() : address(0), length(1), defined(false), absolute(false), equ(-1) {}
+    SymbolTableEntry(Address addr, int len = 1) : address(addr), length(len), defined(true), absolute(false), equ(-1) {}
 };
 
+// The literal's text (e.g. ='5') is interned in AssemblerData::literalTexts
 struct LiteralTableEntry {
-    std::string literal;
+    std::uint32_t text;
     int value;
-    int address; // -1 if not assigned
-    LiteralTableEntry() : value(0), address(-1) {}
-    LiteralTableEntry(const std::string& lit, int val, int addr = -1)
-        : literal(lit), value(val), address(addr) {}
+    Address address; // NO_ADDRESS if not assigned
+    LiteralTableEntry() : text(0), value(0), address(NO_ADDRESS) {}
+    LiteralTableEntry(std::uint32_t txt, int val, Address addr = NO_ADDRESS)
+        : text(txt), value(val), address(addr) {}
+};
+
+// A populated stretch of the address space: [base, base + length) holds
+// `words` emitted words (IS, DC, literals) and DS reservations. Pass 1 maps
+// them so later stages work per segment, never per address in the span.
+struct Segment {
+    Address base;
+    std::uint32_t length;
+    std::uint32_t words;
 };
 
+enum class ICType : std::uint8_t { AD, IS, DL };
+
+enum class OperandKind : std::uint8_t {
+    NONE,   // operand absent
+    R,      // register number
+    CC,     // condition code number
+    C,      // constant
+    S,      // symbol ID
+    L       // literal table index
+};
+
+// Fixed-size packed IC record. The layout is also the on-disk record of the
+// binary IC file (see icfile.cpp), so keep it free of pointers and padding.
 struct IntermediateCodeLine {
-    int lineNumber{0};
-    int locationCounter{0};
-    std::string type;           // AD / IS / DL
-    std::string opcode;         // numeric string
-    std::string operand1Type;   // R / CC / (maybe empty)
-    std::string operand1Value;  // reg/cc number or const
-    std::string operand2Type;   // S / L / (maybe empty)
-    std::string operand2Value;  // symbol name OR literal index
+    std::int32_t lineNumber{0};
+    Address locationCounter{0};
+    ICType type{ICType::AD};
+    std::uint8_t opcode{0};
+    OperandKind operand1Type{OperandKind::NONE};
+    OperandKind operand2Type{OperandKind::NONE};
+    std::int32_t operand1Value{0};  // reg/cc number or const
+    std::int32_t operand2Value{0};  // symbol ID OR literal index
+};
+static_assert(sizeof(IntermediateCodeLine) == 20, "IC record layout is part of the binary IC format");
+
+const char* icTypeName(ICType t);
+const char* operandKindName(OperandKind k);
+
+// One source line split into fields; views point into the caller's line buffer
+struct SourceLine {
+    std::string_view label;
+    std::string_view mnemonic;
+    std::string_view operand1;
+    std::string_view operand2;
+    const Instruction* ins = nullptr;   // MOT entry for the mnemonic (nullptr if unknown)
+};
+
+// A definition or use of a symbol, recorded by pass 1 for the cross-reference
+// index when AssemblerData::crossReference is set (--emit-xref, see xref.hpp)
+enum class ReferenceKind : std::uint8_t {
+    DEFINITION,   // the line's label (EQU included)
+    OPERAND,      // an instruction's memory operand
+    EXPRESSION    // named in a START / ORIGIN / EQU / DS operand
+};
+
+struct SymbolReference {
+    std::uint32_t symbol;   // symbol ID
+    std::uint32_t ic;       // index of the line's IC record (of the next one if it makes none)
+    std::int32_t line;
+    ReferenceKind kind;
+};
+
+// Machine-op, register and condition-code tables. Perfect-hash tables built at
+// compile time (keys upper-case, looked up with findFolded) and shared
+// read-only by every AssemblerData, so concurrent jobs can all use them.
+struct OpcodeTables {
+    StaticTable<Instruction, 18> MOT;
+    StaticTable<int, 4> REGISTERS;
+    StaticTable<int, 6> CONDITION_CODES;
+};
+
+// Pass 2's ID-indexed copies of the symbol and literal tables, so resolving
+// an operand is one array index (see pass2.cpp)
+struct FlatTables {
+    std::pmr::vector<Address> symbolAddress, literalAddress;
+    std::pmr::vector<std::int32_t> literalValue;
+
+    explicit FlatTables(std::pmr::memory_resource* mr = std::pmr::get_default_resource())
+        : symbolAddress(mr), literalAddress(mr), literalValue(mr) {}
+};
+
+// Pass 1 instrumentation (--stats). Point AssemblerData::stats at one of
+// these and pass1() runs serially, timing its phases line by line; left null,
+// counting costs one untaken branch. Table sizes, probe lengths and peak
+// memory are read off the finished tables by writeStatsJson. Building with
+// -DASM_NO_STATS compiles all of it out, the --stats option included.
+#ifndef ASM_NO_STATS
+struct Pass1Stats {
+    double readMs = 0;               // splitting the source into lines
+    double tokenizeMs = 0;           // lexSourceLine
+    double processMs = 0;            // assembling statements, EQU resolution, segment map
+    double writeMs = 0;              // table files (--emit-intermediate / --emit-binary)
+    double pass2Ms = 0;
+    std::size_t lines = 0;
+    std::size_t statements = 0;      // non-blank lines
+    std::size_t motLookups = 0;
+    std::size_t forwardRefs = 0;     // instruction operands naming a symbol not yet defined
 };
+#define ASM_STAT(data, counter) ((data).stats ? (void)++(data).stats->counter : (void)0)
+#else
+#define ASM_STAT(data, counter) ((void)0)
+#endif
 
+// Everything one assembly builds. Every table, interner and error message is
+// allocated from `arena`, the memory resource given to the constructor (the
+// heap by default). Pass a std::pmr::monotonic_buffer_resource that outlives
+// the AssemblerData to get bump allocation and one release for the whole
+// assembly (see main.cpp and bench/bench_arena.cpp). Such a resource is not
+// thread safe: only the thread running pass 1 may grow the tables.
 struct AssemblerData {
-    std::unordered_map<std::string, Instruction> MOT;
-    std::unordered_map<std::string, int> REGISTERS;
-    std::unordered_map<std::string, int> CONDITION_CODES;
-
-    std::map<std::string, SymbolTableEntry> symbolTable;
-    std::vector<LiteralTableEntry> literalTable;
-    std::vector<int> poolTable;
-    std::vector<IntermediateCodeLine> intermediateCode;
-    std::vector<std::string> errors;
-
-    int locationCounter{0};
-    int startingAddress{0};
+    const OpcodeTables* tables = nullptr;        // set by initializeTables
+    std::pmr::memory_resource* arena;
+
+    SymbolInterner symbolIds;                    // name -> dense symbol ID
+    std::pmr::vector<SymbolTableEntry> symbolTable;   // symbol ID -> address/length
+    std::pmr::vector<LiteralTableEntry> literalTable;
+    SymbolInterner literalTexts;                 // literal text -> LiteralTableEntry::text
+    std::pmr::vector<int> poolTable;             // literal table index where each pool starts
+    SymbolInterner poolLiterals;                 // literal text -> ordinal within the current pool
+    std::pmr::vector<IntermediateCodeLine> intermediateCode;
+    std::pmr::vector<Segment> segments;          // sorted by base, disjoint; see buildSegmentMap
+    asmexpr::DeferredList deferredEqus;          // EQUs on forward references, resolved by END
+    std::pmr::vector<std::pmr::string> errors;
+    std::pmr::vector<SymbolReference> references; // filled only if crossReference is set
+    bool crossReference = false;
+
+    std::int64_t locationCounter{0};             // wider than Address so overflow is caught
+    Address startingAddress{0};
+
+    // Scratch reused from run to run
+    asmexpr::Expr expression;                    // directive operand being evaluated
+    FlatTables flatTables;                       // filled by pass2Listing
+#ifndef ASM_NO_STATS
+    Pass1Stats* stats = nullptr;                 // instrumentation, if requested
+#endif
+
+    explicit AssemblerData(std::pmr::memory_resource* mr = std::pmr::get_default_resource());
+
+    // Text of literal table entry `index` (valid until the next literal is added)
+    std::string_view literalText(std::size_t index) const { return literalTexts.name(literalTable[index].text); }
+
+    // Empties everything for the next program but keeps the capacity of every
+    // table, so a context reused for similar programs stops allocating
+    void reset();
 };
 
 // ----- declarations -----
-void initializeTables(AssemblerData& data);
+const OpcodeTables& opcodeTables();         // the shared compile-time tables
+void initializeTables(AssemblerData& data); // points data at the shared tables
 
-// pass 1 & pass 2
+// symbol table helpers
+int addSymbolId(AssemblerData& data, std::string_view name); // new names start undefined
+std::vector<std::uint32_t> symbolsByName(const AssemblerData& data); // IDs in name order, for output
+
+// segment map of the code in `data` (IC + placed literals); pass1 builds it last
+void buildSegmentMap(AssemblerData& data);
+
+// zero-copy lexer for one source line (comments stripped, label detected via the MOT);
+// the second form works from the line's class bits (LineReader::next(line, bits))
+SourceLine lexSourceLine(std::string_view line, const AssemblerData& data);
+SourceLine lexSourceLine(std::string_view line, const asmscan::LineBits& bits, const AssemblerData& data);
+
+// pass 1 & pass 2 (file based: pass1 writes text tables, pass2 re-parses them)
 void pass1(const std::string& inputFile,
            const std::string& intermediateFile,
            const std::string& symbolFile,
@@ -74,11 +228,79 @@ void pass2(const std::string& intermediateFile,
            const std::string& symbolFile,
            const std::string& literalFile,
            const std::string& outputFile,
-           AssemblerData& data);
+           AssemblerData& data,
+           unsigned threads = 1);
+
+// in-process pipeline: pass2 consumes the AssemblerData built by pass1 directly
+bool pass1(const std::string& inputFile, AssemblerData& data, unsigned threads = 1);
+bool pass2(const AssemblerData& data, const std::string& outputFile, unsigned threads = 1);
+
+// embedding API: the whole source in memory, the listing (output.txt format)
+// into a caller-owned string; runs on the calling thread. assemble() resets
+// `data` first and returns false if the program has errors (in data.errors).
+// Once a reused context and listing have grown, a clean program assembles
+// with no heap allocation (bench/bench_embed.cpp counts them).
+bool pass1Source(std::string_view source, AssemblerData& data);
+void pass2Listing(AssemblerData& data, std::string& listing);
+bool assemble(std::string_view source, AssemblerData& data, std::string& listing);
+
+// pass 1 one statement at a time, for drivers that consume the IC as it is
+// made (onepass.cpp); pass1Finish resolves what END would have
+void pass1Statement(const SourceLine& sl, int lineNum, AssemblerData& data);
+void pass1Finish(AssemblerData& data);
+
+// output.txt format, shared by every listing writer. formatListingHead
+// appends an IC record's listing text: nothing for AD, whole lines for DL
+// (returns false). An IS line stops before its address, the last field
+// (returns true): append it with appendInt(buf, address, 4) and a '\n'.
+extern const char MACHINE_CODE_HEADER[];
+bool formatListingHead(const IntermediateCodeLine& ic, std::string& buf);
+void formatLiteralWord(Address address, std::int32_t value, std::string& buf);
+
+// one-pass mode (onepass.cpp): pass 1 only, the listing written as each
+// statement is assembled; forward references are backpatched. Same
+// output.txt as pass1() + pass2().
+struct OnePassStats {
+    std::size_t words = 0;           // IS lines listed
+    std::size_t forwardRefs = 0;     // of them, listed before their symbol/literal had an address
+    std::size_t patchedEarly = 0;    // filled in when the label was defined / the pool placed
+    std::size_t patchedAtEnd = 0;    // filled in after END (deferred EQUs, undefined symbols)
+};
+bool assembleOnePass(const std::string& inputFile, AssemblerData& data, std::string& listing,
+                     OnePassStats& stats);
+
+// text round trip between the passes
+void writePass1Outputs(const AssemblerData& data,
+                       const std::string& intermediateFile,
+                       const std::string& symbolFile,
+                       const std::string& literalFile);
+void loadPass1Outputs(const std::string& intermediateFile,
+                      const std::string& symbolFile,
+                      const std::string& literalFile,
+                      AssemblerData& data);
+
+// batch mode: assemble a directory / list of sources concurrently (batch.cpp)
+int runBatch(const std::string& source, unsigned threads);
+
+// daemon mode: serve assembly requests on a Unix domain socket (daemon.cpp)
+int runServer(const std::string& socketPath, unsigned threads, std::size_t cacheEntries);
+
+// binary IC file: packed records + symbol/literal tables; pass2 mmaps it
+bool writeBinaryIC(const AssemblerData& data, const std::string& binaryFile);
+bool pass2FromBinary(const std::string& binaryFile, const std::string& outputFile,
+                     unsigned threads = 1);
+
+#ifndef ASM_NO_STATS
+// --stats report: the counters and phase times plus table sizes, interner
+// probe lengths and the process's peak RSS, as one JSON object
+bool writeStatsJson(const Pass1Stats& stats, const AssemblerData& data, const std::string& file);
+#endif
 
 // display helpers
 void displaySymbolTable(const AssemblerData& data);
 void displayLiteralTable(const AssemblerData& data);
+void displayPoolTable(const AssemblerData& data);
+void displaySegmentMap(const AssemblerData& data);
 void displayIntermediateCode(const AssemblerData& data);
 void displaySourceCode(const std::string& filename);
 void displayMachineCode(const std::string& filename);
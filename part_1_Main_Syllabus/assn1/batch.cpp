@@ -0,0 +1,116 @@
+// batch.cpp — assembles many source files in one process
+// Input   : a directory (every *.asm in it) or a list file (one path per line)
+// Output  : <source>.out next to each source (machine code, as output.txt)
+// Depends : assembler.hpp; common/thread_pool.hpp (work-stealing job loop)
+//
+// The opcode tables are built once and shared read-only; every job gets its
+// own AssemblerData, so jobs never touch each other's state.
+
+#include "assembler.hpp"
+#include "../../common/asm_lexer.hpp"
+#include "../../common/line_reader.hpp"
+#include "../../common/thread_pool.hpp"
+#include <algorithm>
+#include <chrono>
+#include <filesystem>
+#include <iomanip>
+#include <memory_resource>
+#include <iostream>
+
+namespace fs = std::filesystem;
+using std::string;
+
+struct BatchJob {
+    string source;
+    string output;
+    bool ok = false;
+    string status;   // one-line result shown in the report
+};
+
+// Every *.asm directly inside `dir`, sorted so the report order is stable
+static void listDirectory(const fs::path& dir, std::vector<string>& files) {
+    for (const auto& e : fs::directory_iterator(dir)) {
+        if (e.is_regular_file() && e.path().extension() == ".asm") files.push_back(e.path().string());
+    }
+    std::sort(files.begin(), files.end());
+}
+
+// One path per line; blank lines and lines starting with '#' are skipped
+static bool readListFile(const string& listFile, std::vector<string>& files) {
+    LineReader in;
+    if (!in.open(listFile)) return false;
+    std::string_view line;
+    while (in.next(line)) {
+        line = asmlex::trim(line);
+        if (!line.empty() && line[0] != '#') files.emplace_back(line);
+    }
+    return true;
+}
+
+// <dir>/<stem>.out for <dir>/<stem>.<ext>
+static string outputPathFor(const string& source) {
+    return fs::path(source).replace_extension(".out").string();
+}
+
+static void assembleJob(BatchJob& job) {
+    // Each job's tables live in its own arena, released in one go when it ends
+    std::pmr::monotonic_buffer_resource arena;
+    AssemblerData data(&arena);
+    initializeTables(data);
+    if (!pass1(job.source, data)) {
+        job.status = "cannot open source";
+        return;
+    }
+    if (!data.errors.empty()) {
+        job.status = std::to_string(data.errors.size()) + " error(s), first: " + string(data.errors.front());
+        return;
+    }
+    if (!pass2(data, job.output)) {
+        job.status = "cannot write " + job.output;
+        return;
+    }
+    job.ok = true;
+    job.status = "-> " + job.output + " (" + std::to_string(data.intermediateCode.size()) + " IC records)";
+}
+
+/**
+ * Assembles every file named by `source` (directory or list file)
+ * @param source Directory of .asm files, or a text file listing sources
+ * @param threads Number of concurrent jobs
+ * @return 0 if every file assembled cleanly, 1 otherwise
+ */
+int runBatch(const std::string& source, unsigned threads) {
+    std::vector<string> files;
+    std::error_code ec;
+    if (fs::is_directory(source, ec)) {
+        listDirectory(source, files);
+    } else if (!readListFile(source, files)) {
+        std::cerr << "Error: Cannot open " << source << "\n";
+        return 1;
+    }
+
+    std::vector<BatchJob> jobs(files.size());
+    for (size_t i = 0; i < files.size(); ++i) {
+        jobs[i].source = files[i];
+        jobs[i].output = outputPathFor(files[i]);
+    }
+
+    opcodeTables(); // build the shared tables before any job starts
+
+    using Clock = std::chrono::steady_clock;
+    auto t0 = Clock::now();
+    ThreadPool pool(threads);
+    pool.stealingFor(jobs.size(), [&](size_t i) { assembleJob(jobs[i]); });
+    double seconds = std::chrono::duration<double>(Clock::now() - t0).count();
+
+    size_t ok = 0;
+    for (const BatchJob& job : jobs) {
+        ok += job.ok;
+        std::cout << (job.ok ? "OK    " : "FAIL  ") << job.source << (job.ok ? " " : ": ") << job.status << "\n";
+    }
+    std::cout << std::fixed << std::setprecision(3)
+              << "Batch: " << jobs.size() << " file(s), " << ok << " ok, " << jobs.size() - ok << " failed in "
+              << seconds << " s (" << std::setprecision(1) << (seconds > 0 ? jobs.size() / seconds : 0.0)
+              << " files/s, " << pool.size() << " thread(s))\n";
+    return ok == jobs.size() ? 0 : 1;
+}
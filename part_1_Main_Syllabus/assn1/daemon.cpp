@@ -0,0 +1,378 @@
+// daemon.cpp — long-running assembler behind a Unix domain socket (--serve)
+// Input   : requests on SOCKET, each a source buffer or a source path
+// Output  : per request: machine code (output.txt format), tables, diagnostics
+// Depends : assembler.hpp (assemble(), the embedding API)
+//
+// Protocol (one connection may carry any number of requests, in turn):
+//   request   SOURCE <bytes>\n<bytes of source>
+//             PATH <path>\n                      the daemon reads the file
+//   response  <status> <listing> <tables> <diagnostics> <cache>\n, then that
+//             many bytes of listing, tables and diagnostics
+// status is OK (assembled), FAIL (the program has errors: no listing, the
+// errors are the diagnostics) or ERROR (bad request / unreadable path: the
+// diagnostics say why). cache is "hit" or "miss". The tables are the
+// symbol_table.txt and literal_table.txt lines under "SYMTAB" and "LITTAB".
+//
+// Each worker thread owns one AssemblerData and serves one connection at a
+// time; the context is reset, not rebuilt, between requests, so a warm worker
+// allocates little. Finished responses are kept in an LRU cache keyed by the
+// source text (hashed, then compared), shared by all workers.
+
+#include "assembler.hpp"
+#include <atomic>
+#include <cerrno>
+#include <condition_variable>
+#include <csignal>
+#include <cstring>
+#include <deque>
+#include <fstream>
+#include <iostream>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <thread>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+using std::string;
+using std::string_view;
+
+static const std::size_t kMaxHeader = 4096;
+static const std::size_t kMaxSource = std::size_t(256) << 20;
+
+static std::atomic<bool> stopping{false};
+static int listenFd = -1;
+
+static void onSignal(int) {
+    stopping = true;
+    if (listenFd >= 0) ::shutdown(listenFd, SHUT_RDWR);   // wakes accept()
+}
+
+namespace {
+
+// Finished responses by source text, least recently used first out
+class ResponseCache {
+public:
+    explicit ResponseCache(std::size_t capacity) : capacity_(capacity) {}
+
+    std::shared_ptr<const string> find(string_view source, std::uint64_t hash) {
+        std::lock_guard<std::mutex> lk(m_);
+        auto it = index_.find(hash);
+        if (it == index_.end() || it->second->source != source) return nullptr;
+        lru_.splice(lru_.begin(), lru_, it->second);
+        return it->second->response;
+    }
+
+    void insert(string_view source, std::uint64_t hash, string_view response) {
+        if (capacity_ == 0) return;
+        auto copy = std::make_shared<const string>(response);
+        std::lock_guard<std::mutex> lk(m_);
+        auto it = index_.find(hash);
+        if (it != index_.end()) {           // same hash: the newer source replaces it
+            lru_.erase(it->second);
+            index_.erase(it);
+        }
+        lru_.push_front(Entry{hash, string(source), std::move(copy)});
+        index_[hash] = lru_.begin();
+        if (lru_.size() > capacity_) {
+            index_.erase(lru_.back().hash);
+            lru_.pop_back();
+        }
+    }
+
+private:
+    struct Entry {
+        std::uint64_t hash;
+        string source;
+        std::shared_ptr<const string> response;
+    };
+
+    std::size_t capacity_;
+    std::mutex m_;
+    std::list<Entry> lru_;
+    std::unordered_map<std::uint64_t, std::list<Entry>::iterator> index_;
+};
+
+// Accepted connections waiting for a worker, and the ones being served
+class ConnectionQueue {
+public:
+    void push(int fd) {
+        {
+            std::lock_guard<std::mutex> lk(m_);
+            waiting_.push_back(fd);
+        }
+        cv_.notify_one();
+    }
+
+    // -1 once the daemon is stopping
+    int pop() {
+        std::unique_lock<std::mutex> lk(m_);
+        cv_.wait(lk, [this] { return closed_ || !waiting_.empty(); });
+        if (closed_) return -1;
+        const int fd = waiting_.front();
+        waiting_.pop_front();
+        active_.insert(fd);
+        return fd;
+    }
+
+    void done(int fd) {
+        std::lock_guard<std::mutex> lk(m_);
+        active_.erase(fd);
+        ::close(fd);
+    }
+
+    // Drops waiting connections and ends the ones in progress
+    void close() {
+        std::lock_guard<std::mutex> lk(m_);
+        closed_ = true;
+        for (int fd : waiting_) ::close(fd);
+        waiting_.clear();
+        for (int fd : active_) ::shutdown(fd, SHUT_RDWR);
+        cv_.notify_all();
+    }
+
+private:
+    std::mutex m_;
+    std::condition_variable cv_;
+    std::deque<int> waiting_;
+    std::unordered_set<int> active_;
+    bool closed_ = false;
+};
+
+// Buffered reads from one connection
+class Connection {
+public:
+    explicit Connection(int fd) : fd_(fd) {}
+
+    // The next line without its '\n'; false on EOF or a line over kMaxHeader
+    bool readLine(string& line) {
+        for (;;) {
+            const std::size_t nl = buf_.find('\n', pos_);
+            if (nl != string::npos) {
+                line.assign(buf_, pos_, nl - pos_);
+                pos_ = nl + 1;
+                return true;
+            }
+            if (buf_.size() - pos_ > kMaxHeader || !fill()) return false;
+        }
+    }
+
+    bool readExactly(std::size_t n, string& out) {
+        while (buf_.size() - pos_ < n)
+            if (!fill()) return false;
+        out.assign(buf_, pos_, n);
+        pos_ += n;
+        return true;
+    }
+
+    bool write(string_view data) {
+        while (!data.empty()) {
+            const ssize_t n = ::send(fd_, data.data(), data.size(), MSG_NOSIGNAL);
+            if (n <= 0) return false;
+            data.remove_prefix((std::size_t)n);
+        }
+        return true;
+    }
+
+private:
+    bool fill() {
+        if (pos_ > 0) {
+            buf_.erase(0, pos_);
+            pos_ = 0;
+        }
+        char chunk[1 << 16];
+        const ssize_t n = ::recv(fd_, chunk, sizeof chunk, 0);
+        if (n <= 0) return false;
+        buf_.append(chunk, (std::size_t)n);
+        return true;
+    }
+
+    int fd_;
+    string buf_;
+    std::size_t pos_ = 0;
+};
+
+struct ServerCounters {
+    std::atomic<std::uint64_t> requests{0}, hits{0}, failed{0};
+};
+
+std::uint64_t sourceHash(string_view s) {
+    std::uint64_t h = 14695981039346656037ull;   // FNV-1a, 64-bit
+    for (unsigned char c : s) { h ^= c; h *= 1099511628211ull; }
+    return h;
+}
+
+// "<status> <listing> <tables> <diagnostics> miss\n" + the three bodies
+string frame(const char* status, string_view listing, string_view tables, string_view diagnostics) {
+    string out = status;
+    out += ' ' + std::to_string(listing.size()) + ' ' + std::to_string(tables.size()) + ' ' +
+           std::to_string(diagnostics.size()) + " miss\n";
+    out.append(listing).append(tables).append(diagnostics);
+    return out;
+}
+
+// The symbol_table.txt / literal_table.txt lines of an assembled program
+void formatTables(const AssemblerData& data, string& out) {
+    std::ostringstream os;
+    os << "SYMTAB\n";
+    for (std::uint32_t id : symbolsByName(data))
+        os << data.symbolIds.name(id) << " " << data.symbolTable[id].address << " "
+           << data.symbolTable[id].length << "\n";
+    os << "LITTAB\n";
+    for (std::size_t i = 0; i < data.literalTable.size(); ++i)
+        os << i << " " << data.literalText(i) << " " << data.literalTable[i].value << " "
+           << printedAddress(data.literalTable[i].address) << "\n";
+    out = os.str();
+}
+
+// A worker: one warm context, connections served one at a time
+class Worker {
+public:
+    Worker(ResponseCache& cache, ServerCounters& counters) : cache_(cache), counters_(counters) {
+        initializeTables(data_);
+    }
+
+    void serve(int fd) {
+        Connection conn(fd);
+        string header, source, error;
+        while (conn.readLine(header)) {
+            bool fatal = false;
+            ++counters_.requests;
+            if (readSource(conn, header, source, error, fatal)) {
+                if (!respond(conn, source)) return;
+                continue;
+            }
+            ++counters_.failed;
+            // A bad header is still answered before a fatal close; a lost payload has no one to answer
+            if (!error.empty() && !conn.write(frame("ERROR", {}, {}, error + "\n"))) return;
+            if (fatal) return;
+        }
+    }
+
+private:
+    // Parses a request; false with `error` set for a bad one, and `fatal`
+    // when the connection cannot continue (the payload boundary is lost, or
+    // the payload could not be read: then `error` is left empty)
+    bool readSource(Connection& conn, const string& header, string& source, string& error, bool& fatal) {
+        if (header.compare(0, 7, "SOURCE ") == 0) {
+            char* end = nullptr;
+            const unsigned long long n = std::strtoull(header.c_str() + 7, &end, 10);
+            if (end == header.c_str() + 7 || *end != '\0' || n > kMaxSource) {
+                error = "bad SOURCE length";
+                fatal = true;            // the payload boundary is lost
+                return false;
+            }
+            if (!conn.readExactly((std::size_t)n, source)) {
+                error.clear();
+                fatal = true;
+                return false;
+            }
+            return true;
+        }
+        if (header.compare(0, 5, "PATH ") == 0) {
+            std::ifstream in(header.substr(5), std::ios::binary);
+            if (!in) {
+                error = "cannot open " + header.substr(5);
+                return false;
+            }
+            std::ostringstream os;
+            os << in.rdbuf();
+            source = os.str();
+            return true;
+        }
+        error = "unknown request (expected SOURCE <bytes> or PATH <path>)";
+        return false;
+    }
+
+    // Writes the response for `source`, from the cache if it is there
+    bool respond(Connection& conn, const string& source) {
+        const std::uint64_t hash = sourceHash(source);
+        if (std::shared_ptr<const string> hit = cache_.find(source, hash)) {
+            ++counters_.hits;
+            const string_view r = *hit;
+            const std::size_t nl = r.find('\n');
+            head_.assign(r.substr(0, nl - 4)).append("hit\n");    // cached as "... miss"
+            return conn.write(head_) && conn.write(r.substr(nl + 1));
+        }
+        if (assemble(source, data_, listing_)) {
+            formatTables(data_, tables_);
+            scratch_ = frame("OK", listing_, tables_, {});
+        } else {
+            diagnostics_.clear();
+            for (const auto& e : data_.errors) diagnostics_.append(e.data(), e.size()).push_back('\n');
+            scratch_ = frame("FAIL", {}, {}, diagnostics_);
+        }
+        cache_.insert(source, hash, scratch_);
+        return conn.write(scratch_);
+    }
+
+    ResponseCache& cache_;
+    ServerCounters& counters_;
+    AssemblerData data_;
+    string listing_, tables_, diagnostics_, scratch_, head_;
+};
+
+} // namespace
+
+/**
+ * Serves assembly requests on a Unix domain socket until SIGINT/SIGTERM
+ * @param socketPath Filesystem path of the socket (replaced if it exists)
+ * @param threads Worker threads, i.e. connections served at once
+ * @param cacheEntries Responses kept in the LRU cache (0 = no cache)
+ * @return 0 after a clean shutdown, 1 if the socket could not be set up
+ */
+int runServer(const std::string& socketPath, unsigned threads, std::size_t cacheEntries) {
+    sockaddr_un addr{};
+    if (socketPath.size() >= sizeof addr.sun_path) {
+        std::cerr << "Error: socket path too long: " << socketPath << "\n";
+        return 1;
+    }
+    addr.sun_family = AF_UNIX;
+    std::memcpy(addr.sun_path, socketPath.c_str(), socketPath.size() + 1);
+
+    listenFd = ::socket(AF_UNIX, SOCK_STREAM, 0);
+    ::unlink(socketPath.c_str());
+    if (listenFd < 0 || ::bind(listenFd, (const sockaddr*)&addr, sizeof addr) != 0 || ::listen(listenFd, 128) != 0) {
+        std::cerr << "Error: cannot listen on " << socketPath << ": " << std::strerror(errno) << "\n";
+        return 1;
+    }
+    struct sigaction sa {};
+    sa.sa_handler = onSignal;           // no SA_RESTART: accept() returns on a signal
+    sigaction(SIGINT, &sa, nullptr);
+    sigaction(SIGTERM, &sa, nullptr);
+
+    ResponseCache cache(cacheEntries);
+    ServerCounters counters;
+    ConnectionQueue queue;
+    threads = std::max(1u, threads);
+    std::vector<std::thread> workers;
+    for (unsigned i = 0; i < threads; ++i) {
+        workers.emplace_back([&] {
+            Worker w(cache, counters);
+            for (int fd; (fd = queue.pop()) >= 0;) {
+                w.serve(fd);
+                queue.done(fd);
+            }
+        });
+    }
+    std::cout << "Serving on " << socketPath << " (" << threads << " worker(s), cache " << cacheEntries
+              << " entries); Ctrl-C to stop" << std::endl;
+
+    while (!stopping) {
+        const int fd = ::accept(listenFd, nullptr, nullptr);
+        if (fd >= 0) queue.push(fd);
+        else if (errno != EINTR && errno != ECONNABORTED) break;
+    }
+    queue.close();
+    for (std::thread& t : workers) t.join();
+    ::close(listenFd);
+    ::unlink(socketPath.c_str());
+    std::cout << "Served " << counters.requests << " request(s): " << counters.hits << " from the cache, "
+              << counters.failed << " bad" << std::endl;
+    return 0;
+}
@@ -2,6 +2,9 @@
 #include <iostream>
 #include <fstream>
 #include <iomanip>
+#ifndef ASM_NO_STATS
+#include <sys/resource.h>
+#endif
 
 using std::cout; using std::endl; using std::left; using std::setw; using std::string;
 
@@ -11,8 +14,9 @@ void displaySymbolTable(const AssemblerData& data) {
     cout << string(60, '=') << endl;
     cout << left << setw(20) << "Symbol" << setw(15) << "Address" << setw(10) << "Length" << endl;
     cout << string(60, '-') << endl;
-    for (const auto& p : data.symbolTable)
-        cout << left << setw(20) << p.second.symbol << setw(15) << p.second.address << setw(10) << p.second.length << endl;
+    for (std::uint32_t id : symbolsByName(data))
+        cout << left << setw(20) << data.symbolIds.name(id) << setw(15) << data.symbolTable[id].address
+             << setw(10) << data.symbolTable[id].length << endl;
 }
 
 void displayLiteralTable(const AssemblerData& data) {
@@ -22,8 +26,29 @@ void displayLiteralTable(const AssemblerData& data) {
     cout << left << setw(10) << "Index" << setw(20) << "Literal" << setw(15) << "Value" << setw(15) << "Address" << endl;
     cout << string(60, '-') << endl;
     for (size_t i=0;i<data.literalTable.size();++i)
-        cout << left << setw(10) << i << setw(20) << data.literalTable[i].literal
-             << setw(15) << data.literalTable[i].value << setw(15) << data.literalTable[i].address << endl;
+        cout << left << setw(10) << i << setw(20) << data.literalText(i)
+             << setw(15) << data.literalTable[i].value << setw(15) << printedAddress(data.literalTable[i].address) << endl;
+}
+
+void displayPoolTable(const AssemblerData& data) {
+    cout << "\n" << string(60, '=') << endl;
+    cout << "POOL TABLE" << endl;
+    cout << string(60, '=') << endl;
+    cout << left << setw(10) << "Pool" << setw(20) << "First Literal" << endl;
+    cout << string(60, '-') << endl;
+    for (size_t i=0;i<data.poolTable.size();++i)
+        cout << left << setw(10) << i << setw(20) << data.poolTable[i] << endl;
+}
+
+void displaySegmentMap(const AssemblerData& data) {
+    cout << "\n" << string(60, '=') << endl;
+    cout << "SEGMENT MAP" << endl;
+    cout << string(60, '=') << endl;
+    cout << left << setw(15) << "Base" << setw(15) << "End" << setw(15) << "Length" << setw(10) << "Words" << endl;
+    cout << string(60, '-') << endl;
+    for (const Segment& s : data.segments)
+        cout << left << setw(15) << s.base << setw(15) << (std::uint64_t)s.base + s.length - 1
+             << setw(15) << s.length << setw(10) << s.words << endl;
 }
 
 void displayIntermediateCode(const AssemblerData& data) {
@@ -35,14 +60,16 @@ void displayIntermediateCode(const AssemblerData& data) {
 
     for (const auto& ic : data.intermediateCode) {
         cout << left << setw(8) << ic.locationCounter;
-        string instr = "(" + ic.type + "," + ic.opcode + ")";
+        string instr = string("(") + icTypeName(ic.type) + "," + std::to_string(ic.opcode) + ")";
         cout << setw(15) << instr;
-        if (!ic.operand1Type.empty()) {
-            string op1 = "(" + ic.operand1Type + "," + ic.operand1Value + ")";
+        if (ic.operand1Type != OperandKind::NONE) {
+            string op1 = string("(") + operandKindName(ic.operand1Type) + "," + std::to_string(ic.operand1Value) + ")";
             cout << setw(20) << op1;
         } else cout << setw(20) << " ";
-        if (!ic.operand2Type.empty()) {
-            string op2 = "(" + ic.operand2Type + "," + ic.operand2Value + ")";
+        if (ic.operand2Type != OperandKind::NONE) {
+            string val = ic.operand2Type == OperandKind::S ? string(data.symbolIds.name(ic.operand2Value))
+                                                           : std::to_string(ic.operand2Value);
+            string op2 = string("(") + operandKindName(ic.operand2Type) + "," + val + ")";
             cout << setw(20) << op2;
         }
         cout << endl;
@@ -73,3 +100,35 @@ void displayErrors(const AssemblerData& data) {
         for (const auto& e : data.errors) cout << e << endl;
     }
 }
+
+#ifndef ASM_NO_STATS
+static void writeProbeStats(std::ostream& out, const char* name, const SymbolInterner& table) {
+    const SymbolInterner::ProbeStats p = table.probeStats();
+    out << "    \"" << name << "\": {\"names\": " << p.names << ", \"slots\": " << p.slots
+        << ", \"mean_probes\": " << p.meanProbes << ", \"max_probes\": " << p.maxProbes << "}";
+}
+
+bool writeStatsJson(const Pass1Stats& stats, const AssemblerData& data, const string& file) {
+    std::ofstream out(file);
+    if (!out.is_open()) { std::cerr << "Error: Cannot create " << file << endl; return false; }
+    struct rusage ru {};
+    getrusage(RUSAGE_SELF, &ru);
+
+    out << std::fixed << std::setprecision(3)
+        << "{\n  \"phases_ms\": {\"read\": " << stats.readMs << ", \"tokenize\": " << stats.tokenizeMs
+        << ", \"process\": " << stats.processMs << ", \"table_write\": " << stats.writeMs
+        << ", \"pass2\": " << stats.pass2Ms << "},\n"
+        << "  \"counts\": {\"lines\": " << stats.lines << ", \"statements\": " << stats.statements
+        << ", \"ic_records\": " << data.intermediateCode.size() << ", \"symbols\": " << data.symbolTable.size()
+        << ", \"forward_references\": " << stats.forwardRefs << ", \"literals\": " << data.literalTable.size()
+        << ", \"literal_pools\": " << data.poolTable.size() << ", \"mot_lookups\": " << stats.motLookups
+        << ", \"errors\": " << data.errors.size() << "},\n"
+        << "  \"hash_tables\": {\n";
+    writeProbeStats(out, "symbols", data.symbolIds);
+    out << ",\n";
+    writeProbeStats(out, "literals", data.literalTexts);
+    out << "\n  },\n"
+        << "  \"peak_rss_kib\": " << ru.ru_maxrss << "\n}\n";
+    return (bool)out;
+}
+#endif
@@ -0,0 +1,122 @@
+// icfile.cpp — writer and mmap reader for the binary IC file (see icfile.hpp)
+
+#include "icfile.hpp"
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <vector>
+
+using std::string;
+
+template <typename T, typename A>
+static void writeArray(std::ofstream& out, const std::vector<T, A>& v) {
+    if (!v.empty()) out.write(reinterpret_cast<const char*>(v.data()), (std::streamsize)(v.size() * sizeof(T)));
+}
+
+// Serializes pass1's tables as intermediate.bin
+bool writeBinaryIC(const AssemblerData& data, const string& binaryFile) {
+    std::ofstream out(binaryFile, std::ios::binary);
+    if (!out.is_open()) {
+        std::cerr << "Error: Cannot create " << binaryFile << "\n";
+        return false;
+    }
+
+    const size_t nsym = data.symbolTable.size();
+    std::vector<Address> symAddr;
+    std::vector<std::int32_t> symLen;
+    for (const auto& e : data.symbolTable) {
+        symAddr.push_back(e.address);
+        symLen.push_back(e.length);
+    }
+
+    string strings;
+    std::vector<std::uint32_t> symName, litText;
+    for (std::uint32_t id = 0; id < nsym; ++id) {
+        symName.push_back((std::uint32_t)strings.size());
+        strings += data.symbolIds.name(id);
+    }
+    symName.push_back((std::uint32_t)strings.size());
+
+    std::vector<std::int32_t> litValue;
+    std::vector<Address> litAddr;
+    for (const auto& L : data.literalTable) {
+        litValue.push_back(L.value);
+        litAddr.push_back(L.address);
+        litText.push_back((std::uint32_t)strings.size());
+        strings += data.literalTexts.name(L.text);
+    }
+    litText.push_back((std::uint32_t)strings.size());
+    strings.resize((strings.size() + 3) & ~size_t(3), '\0'); // keep the file 4-byte aligned
+
+    BinaryICHeader h{};
+    std::memcpy(h.magic, BINARY_IC_MAGIC, sizeof h.magic);
+    h.version         = BINARY_IC_VERSION;
+    h.recordSize      = sizeof(IntermediateCodeLine);
+    h.icCount         = (std::uint32_t)data.intermediateCode.size();
+    h.symbolCount     = (std::uint32_t)nsym;
+    h.literalCount    = (std::uint32_t)data.literalTable.size();
+    h.stringBytes     = (std::uint32_t)strings.size();
+    h.startingAddress = data.startingAddress;
+
+    out.write(reinterpret_cast<const char*>(&h), sizeof h);
+    writeArray(out, data.intermediateCode);
+    writeArray(out, symAddr);
+    writeArray(out, symLen);
+    writeArray(out, symName);
+    writeArray(out, litValue);
+    writeArray(out, litAddr);
+    writeArray(out, litText);
+    out.write(strings.data(), (std::streamsize)strings.size());
+    return (bool)out;
+}
+
+// True if `count + 1` string offsets never decrease and end inside the pool
+static bool offsetsValid(const std::uint32_t* offset, std::uint32_t count, std::uint32_t stringBytes) {
+    for (std::uint32_t i = 0; i < count; ++i)
+        if (offset[i] > offset[i + 1]) return false;
+    return offset[count] <= stringBytes;
+}
+
+bool BinaryICFile::open(const string& path, string& error) {
+    if (!file_.open(path)) { error = "Cannot open " + path; return false; }
+    if (file_.size() < sizeof(BinaryICHeader)) { error = path + ": truncated header"; return false; }
+
+    hdr_ = reinterpret_cast<const BinaryICHeader*>(file_.data());
+    if (std::memcmp(hdr_->magic, BINARY_IC_MAGIC, sizeof hdr_->magic) != 0) { error = path + ": not a binary IC file"; return false; }
+    if (hdr_->version != BINARY_IC_VERSION || hdr_->recordSize != sizeof(IntermediateCodeLine)) {
+        error = path + ": unsupported binary IC version";
+        return false;
+    }
+
+    const std::uint64_t need = sizeof(BinaryICHeader)
+        + (std::uint64_t)hdr_->icCount * sizeof(IntermediateCodeLine)
+        + (std::uint64_t)hdr_->symbolCount * 12 + 4
+        + (std::uint64_t)hdr_->literalCount * 12 + 4
+        + hdr_->stringBytes;
+    if (file_.size() < need) { error = path + ": truncated file"; return false; }
+
+    const char* p = file_.data() + sizeof(BinaryICHeader);
+    auto take = [&p](size_t bytes) { const char* q = p; p += bytes; return q; };
+    code_     = reinterpret_cast<const IntermediateCodeLine*>(take(hdr_->icCount * sizeof(IntermediateCodeLine)));
+    symAddr_  = reinterpret_cast<const Address*>(take(hdr_->symbolCount * 4));
+    take(hdr_->symbolCount * 4);   // symbolLength, which Pass 2 does not need
+    symName_  = reinterpret_cast<const std::uint32_t*>(take((hdr_->symbolCount + 1) * 4));
+    litValue_ = reinterpret_cast<const std::int32_t*>(take(hdr_->literalCount * 4));
+    litAddr_  = reinterpret_cast<const Address*>(take(hdr_->literalCount * 4));
+    litText_  = reinterpret_cast<const std::uint32_t*>(take((hdr_->literalCount + 1) * 4));
+    strings_  = take(hdr_->stringBytes);
+    if (!offsetsValid(symName_, hdr_->symbolCount, hdr_->stringBytes) ||
+        !offsetsValid(litText_, hdr_->literalCount, hdr_->stringBytes)) {
+        error = path + ": inconsistent tables";
+        return false;
+    }
+    return true;
+}
+
+std::string_view BinaryICFile::symbolName(std::uint32_t id) const {
+    return std::string_view(strings_ + symName_[id], symName_[id + 1] - symName_[id]);
+}
+
+std::string_view BinaryICFile::literalText(std::uint32_t i) const {
+    return std::string_view(strings_ + litText_[i], litText_[i + 1] - litText_[i]);
+}
@@ -0,0 +1,59 @@
+#pragma once
+// icfile.hpp — stable binary form of Pass 1 output (intermediate.bin)
+//
+// Layout (little-endian, 4-byte aligned, written in this order):
+//   BinaryICHeader
+//   IntermediateCodeLine records[icCount]
+//   uint32 symbolAddress[symbolCount]        indexed by symbol ID
+//   int32  symbolLength[symbolCount]
+//   uint32 symbolNameOffset[symbolCount + 1] into the string pool
+//   int32  literalValue[literalCount]
+//   uint32 literalAddress[literalCount]      0xFFFFFFFF = unassigned
+//   uint32 literalTextOffset[literalCount + 1]
+//   char   strings[stringBytes]
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include "assembler.hpp"
+#include "../../common/mapped_file.hpp"
+
+constexpr char          BINARY_IC_MAGIC[8] = {'A','S','M','I','C','\0','\0','\0'};
+constexpr std::uint32_t BINARY_IC_VERSION  = 1;
+
+struct BinaryICHeader {
+    char          magic[8];
+    std::uint32_t version;
+    std::uint32_t recordSize;      // sizeof(IntermediateCodeLine)
+    std::uint32_t icCount;
+    std::uint32_t symbolCount;
+    std::uint32_t literalCount;
+    std::uint32_t stringBytes;
+    std::uint32_t startingAddress;
+    std::uint32_t reserved;
+};
+static_assert(sizeof(BinaryICHeader) == 40, "binary IC header layout");
+
+// Read-only view over a mapped intermediate.bin; all pointers point into the mapping.
+class BinaryICFile {
+public:
+    bool open(const std::string& path, std::string& error);
+
+    const BinaryICHeader&       header() const { return *hdr_; }
+    const IntermediateCodeLine* code() const { return code_; }
+    const Address*              symbolAddress() const { return symAddr_; }
+    const std::int32_t*         literalValue() const { return litValue_; }
+    const Address*              literalAddress() const { return litAddr_; }
+    std::string_view            symbolName(std::uint32_t id) const;
+    std::string_view            literalText(std::uint32_t i) const;
+
+private:
+    MappedFile file_;
+    const BinaryICHeader*       hdr_ = nullptr;
+    const IntermediateCodeLine* code_ = nullptr;
+    const Address*              symAddr_ = nullptr;
+    const std::uint32_t*        symName_ = nullptr;
+    const std::int32_t*         litValue_ = nullptr;
+    const Address*              litAddr_ = nullptr;
+    const std::uint32_t*        litText_ = nullptr;
+    const char*                 strings_ = nullptr;
+};
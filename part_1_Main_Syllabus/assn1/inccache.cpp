@@ -0,0 +1,132 @@
+// inccache.cpp — incremental cache file and the --incremental driver (see inccache.hpp)
+
+#include "inccache.hpp"
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+
+using std::string;
+
+template <typename T, typename A>
+static void writeArray(std::ofstream& out, const std::vector<T, A>& v) {
+    if (!v.empty()) out.write(reinterpret_cast<const char*>(v.data()), (std::streamsize)(v.size() * sizeof(T)));
+}
+
+bool writeIncrementalCache(const AssemblerData& data, const IncrementalRun& run, const string& cacheFile) {
+    std::ofstream out(cacheFile, std::ios::binary);
+    if (!out.is_open()) {
+        std::cerr << "Error: Cannot create " << cacheFile << "\n";
+        return false;
+    }
+
+    string strings;
+    std::vector<std::uint32_t> symName, litText;
+    for (std::uint32_t id = 0; id < data.symbolTable.size(); ++id) {
+        symName.push_back((std::uint32_t)strings.size());
+        strings += data.symbolIds.name(id);
+    }
+    symName.push_back((std::uint32_t)strings.size());
+    for (const auto& L : data.literalTable) {
+        litText.push_back((std::uint32_t)strings.size());
+        strings += data.literalTexts.name(L.text);
+    }
+    litText.push_back((std::uint32_t)strings.size());
+    if ((symName.size() + litText.size()) % 2) litText.push_back(0); // 8-byte align the strings
+    const size_t stringBytes = strings.size();
+    strings.resize((strings.size() + 7) & ~size_t(7), '\0');
+
+    IncCacheHeader h{};
+    std::memcpy(h.magic, INC_CACHE_MAGIC, sizeof h.magic);
+    h.version      = INC_CACHE_VERSION;
+    h.recordSize   = sizeof(CachedLine);
+    h.lineCount    = (std::uint32_t)run.lines.size();
+    h.symbolCount  = (std::uint32_t)data.symbolTable.size();
+    h.literalCount = (std::uint32_t)data.literalTable.size();
+    h.stringBytes  = (std::uint32_t)stringBytes;
+    h.codeBytes    = run.code.size();
+
+    out.write(reinterpret_cast<const char*>(&h), sizeof h);
+    writeArray(out, run.lines);
+    writeArray(out, symName);
+    writeArray(out, litText);
+    out.write(strings.data(), (std::streamsize)strings.size());
+    out.write(run.code.data(), (std::streamsize)run.code.size());
+    return (bool)out;
+}
+
+// True if `count + 1` offsets never decrease and end at or before `limit`
+static bool offsetsValid(const std::uint32_t* offset, std::uint32_t count, std::uint32_t limit) {
+    for (std::uint32_t i = 0; i < count; ++i)
+        if (offset[i] > offset[i + 1]) return false;
+    return offset[count] <= limit;
+}
+
+// True if every ID and code slice a cached line holds stays inside the cache
+static bool lineValid(const CachedLine& l, const IncCacheHeader& h) {
+    if (l.kind > CachedLineKind::CODE) return false;
+    if (l.label < -1 || (l.label >= 0 && (std::uint32_t)l.label >= h.symbolCount)) return false;
+    if (l.kind == CachedLineKind::CODE) {
+        if (l.operand2Type == OperandKind::S && (l.operand2Value < 0 || (std::uint32_t)l.operand2Value >= h.symbolCount)) return false;
+        if (l.operand2Type == OperandKind::L && (l.operand2Value < 0 || (std::uint32_t)l.operand2Value >= h.literalCount)) return false;
+    }
+    return (std::uint64_t)l.codeOffset + l.codeLength <= h.codeBytes;
+}
+
+bool IncrementalCache::open(const string& path) {
+    hdr_ = nullptr;
+    if (!file_.open(path) || file_.size() < sizeof(IncCacheHeader)) return false;
+
+    const IncCacheHeader* h = reinterpret_cast<const IncCacheHeader*>(file_.data());
+    if (std::memcmp(h->magic, INC_CACHE_MAGIC, sizeof h->magic) != 0 ||
+        h->version != INC_CACHE_VERSION || h->recordSize != sizeof(CachedLine)) return false;
+
+    const std::uint64_t offsets = (std::uint64_t)h->symbolCount + 1 + h->literalCount + 1;
+    const std::uint64_t stringBytes = ((std::uint64_t)h->stringBytes + 7) & ~std::uint64_t(7);
+    const std::uint64_t need = sizeof(IncCacheHeader)
+        + (std::uint64_t)h->lineCount * sizeof(CachedLine)
+        + (offsets + offsets % 2) * 4
+        + stringBytes + h->codeBytes;
+    if (file_.size() < need) return false;
+
+    const char* p = file_.data() + sizeof(IncCacheHeader);
+    auto take = [&p](std::uint64_t bytes) { const char* q = p; p += bytes; return q; };
+    lines_   = reinterpret_cast<const CachedLine*>(take((std::uint64_t)h->lineCount * sizeof(CachedLine)));
+    symName_ = reinterpret_cast<const std::uint32_t*>(take(((std::uint64_t)h->symbolCount + 1) * 4));
+    litText_ = reinterpret_cast<const std::uint32_t*>(take(((std::uint64_t)h->literalCount + 1 + offsets % 2) * 4));
+    strings_ = take(stringBytes);
+    code_    = take(h->codeBytes);
+    if (!offsetsValid(symName_, h->symbolCount, h->stringBytes) ||
+        !offsetsValid(litText_, h->literalCount, h->stringBytes)) return false;
+    for (std::uint32_t i = 0; i < h->lineCount; ++i)
+        if (!lineValid(lines_[i], *h)) return false;
+    hdr_ = h;
+    return true;
+}
+
+std::string_view IncrementalCache::symbolName(std::uint32_t id) const {
+    return std::string_view(strings_ + symName_[id], symName_[id + 1] - symName_[id]);
+}
+
+std::string_view IncrementalCache::literalText(std::uint32_t i) const {
+    return std::string_view(strings_ + litText_[i], litText_[i + 1] - litText_[i]);
+}
+
+bool assembleIncremental(const string& inputFile, const string& cacheFile,
+                         const string& outputFile, AssemblerData& data, IncrementalRun& run) {
+    IncrementalCache old;
+    run.cacheUsed = old.open(cacheFile); // a missing, stale or corrupt cache just means every line is new
+
+    if (!pass1Incremental(inputFile, old, data, run)) return false;
+    if (!data.errors.empty()) return true;
+    if (!pass2Incremental(data, old, run, outputFile)) return false;
+
+    // Write next to the old cache and swap it in, so a failed write never leaves a torn cache
+    const string tmp = cacheFile + ".tmp";
+    if (!writeIncrementalCache(data, run, tmp)) return false;
+    if (std::rename(tmp.c_str(), cacheFile.c_str()) != 0) {
+        std::cerr << "Error: Cannot replace " << cacheFile << "\n";
+        return false;
+    }
+    return true;
+}
@@ -0,0 +1,119 @@
+#pragma once
+// inccache.hpp — per-line cache for incremental reassembly (--incremental)
+//
+// Every source line is cached under a hash of its text together with what
+// Pass 1 derived from that text alone (IC fields, LC delta, label) and the
+// machine code Pass 2 produced for it. On the next run unchanged lines (found
+// by hash wherever they now are, see pass1Incremental) are replayed from the
+// cache without being lexed: their LCs shift, their symbols/literals are
+// re-resolved, and their machine code is copied unless the LC or the
+// resolved address changed.
+//
+// Layout (little-endian, 8-byte aligned, written in this order):
+//   IncCacheHeader
+//   CachedLine lines[lineCount]
+//   uint32 symbolNameOffset[symbolCount + 1]    symbol IDs of the writing run
+//   uint32 literalTextOffset[literalCount + 1]  literal indices of the writing run
+//   char   strings[stringBytes]                 padded to 8 bytes
+//   char   code[codeBytes]                      machine-code text, see CachedLine
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "assembler.hpp"
+#include "../../common/mapped_file.hpp"
+
+constexpr char          INC_CACHE_MAGIC[8] = {'A','S','M','I','N','C','\0','\0'};
+constexpr std::uint32_t INC_CACHE_VERSION  = 1;
+
+struct IncCacheHeader {
+    char          magic[8];
+    std::uint32_t version;
+    std::uint32_t recordSize;      // sizeof(CachedLine)
+    std::uint32_t lineCount;
+    std::uint32_t symbolCount;
+    std::uint32_t literalCount;
+    std::uint32_t stringBytes;
+    std::uint64_t codeBytes;
+};
+static_assert(sizeof(IncCacheHeader) == 40, "incremental cache header layout");
+
+enum class CachedLineKind : std::uint8_t {
+    BLANK,  // no statement (empty / comment only)
+    RELEX,  // directive or erroneous line: always lexed again
+    CODE    // IS/DS/DC line: replayed from the fields below
+};
+
+struct CachedLine {
+    std::uint64_t  hash{0};                    // hash of the raw line text
+    CachedLineKind kind{CachedLineKind::BLANK};
+    ICType         type{ICType::AD};
+    std::uint8_t   opcode{0};
+    OperandKind    operand1Type{OperandKind::NONE};
+    OperandKind    operand2Type{OperandKind::NONE};
+    std::uint8_t   pad[3]{};
+    std::int32_t   operand1Value{0};
+    std::int32_t   operand2Value{0};           // symbol ID / literal index (writing run)
+    std::int32_t   label{-1};                  // symbol ID of the label, -1 if none
+    std::int32_t   lcDelta{0};                 // words the line occupies
+    // Pass 2: the machine code and what it was built from
+    std::uint32_t  locationCounter{0};
+    std::int32_t   resolved{0};                // address field (IS) or operand value (DL), as stored
+    std::uint32_t  codeOffset{0};
+    std::uint32_t  codeLength{0};
+};
+static_assert(sizeof(CachedLine) == 48, "incremental cache record layout");
+
+// FNV-1a over the line; the cache only ever compares hashes of lines
+inline std::uint64_t hashLine(std::string_view s) {
+    std::uint64_t h = 14695981039346656037ull;
+    for (unsigned char c : s) { h ^= c; h *= 1099511628211ull; }
+    return h;
+}
+
+// Read-only view over a mapped cache file; an unopened cache has no lines
+class IncrementalCache {
+public:
+    bool open(const std::string& path);
+
+    std::uint32_t     lineCount() const { return hdr_ ? hdr_->lineCount : 0; }
+    std::uint32_t     symbolCount() const { return hdr_ ? hdr_->symbolCount : 0; }
+    const CachedLine& line(std::uint32_t i) const { return lines_[i]; }
+    std::string_view  symbolName(std::uint32_t id) const;
+    std::string_view  literalText(std::uint32_t i) const;
+    std::string_view  code(const CachedLine& l) const { return std::string_view(code_ + l.codeOffset, l.codeLength); }
+
+private:
+    MappedFile file_;
+    const IncCacheHeader* hdr_ = nullptr;
+    const CachedLine*     lines_ = nullptr;
+    const std::uint32_t*  symName_ = nullptr;
+    const std::uint32_t*  litText_ = nullptr;
+    const char*           strings_ = nullptr;
+    const char*           code_ = nullptr;
+};
+
+// What one incremental run produced, and how much of it was actually redone
+struct IncrementalRun {
+    std::vector<CachedLine>   lines;    // next cache entries, one per source line
+    std::vector<std::int32_t> oldLine;  // cache line each source line matched, -1 if changed
+    std::string               code;     // machine-code text the entries point into
+    size_t changed = 0;                 // lines not found in the cache
+    size_t reprocessed = 0;             // lines lexed (changed + directives/errors)
+    size_t codeLines = 0;               // lines that produce machine code
+    size_t regenerated = 0;             // of those, lines whose machine code was rebuilt
+    bool   cacheUsed = false;
+};
+
+// pass1.cpp / pass2.cpp halves of the incremental pipeline
+bool pass1Incremental(const std::string& inputFile, const IncrementalCache& old,
+                      AssemblerData& data, IncrementalRun& run);
+bool pass2Incremental(const AssemblerData& data, const IncrementalCache& old,
+                      IncrementalRun& run, const std::string& outputFile);
+
+bool writeIncrementalCache(const AssemblerData& data, const IncrementalRun& run, const std::string& cacheFile);
+
+// Pass 1 + Pass 2 against `cacheFile`, which is then replaced with this run's cache.
+// Returns false on I/O errors; with assembly errors Pass 2 is skipped and the cache kept.
+bool assembleIncremental(const std::string& inputFile, const std::string& cacheFile,
+                         const std::string& outputFile, AssemblerData& data, IncrementalRun& run);
@@ -1,45 +1,497 @@
+#include <fstream>
 #include <iostream>
 #include <iomanip>
+#include <memory_resource>
 #include <string>
+#include <chrono>
+#include <cstdlib>
+#include <algorithm>
+#include <thread>
 #include "assembler.hpp"
+#include "inccache.hpp"
+#include "objfile.hpp"
+#include "vm.hpp"
+#include "xref.hpp"
+
+struct Options {
+    std::string inputFile = "input.txt";
+    bool emitIntermediate = false; // write intermediate/symbol/literal text files
+    bool viaFiles = false;         // legacy pipeline: pass2 re-parses the text files
+    bool emitBinary = false;       // write intermediate.bin
+    bool viaBinary = false;        // pass2 mmaps intermediate.bin
+    bool emitXref = false;         // write the cross-reference index xref.bin
+    std::string whoReferences;     // look this symbol up in xref.bin
+    int timeRuns = 0;              // > 0: time every pipeline instead of assembling once
+    unsigned threads = 1;          // threads for pass1 and pass2 (0 = one per core)
+    std::string batch;             // directory or list file: assemble every source in it
+    std::string serve;             // daemon mode: Unix socket to listen on
+    std::size_t cacheEntries = 256;   // daemon's response cache
+    std::string cacheFile;         // incremental mode: per-line cache from the previous run
+    bool emitObject = false;       // pass2 writes output.obj; output.txt is rendered from it
+    bool listing = true;           // write output.txt
+    bool collapseDS = false;       // list each DS range as one line
+    std::string listObject;        // load this object file and write its listing
+    bool rebase = false;           // relocate the loaded object to `base`
+    Address base = 0;
+    bool onePass = false;          // single pass with backpatching (onepass.cpp)
+    std::string runFile;           // execute this object file / listing (vm.cpp)
+    std::string runInput = "-";    // READ input for --run
+    unsigned long long maxSteps = 0;
+#ifndef ASM_NO_STATS
+    std::string statsFile;         // write pass 1 instrumentation here as JSON
+#endif
+};
+
+#ifndef ASM_NO_STATS
+static double msSince(std::chrono::steady_clock::time_point t0) {
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - t0).count();
+}
+#endif
+
+static void usage(const char* prog) {
+    std::cerr << "Usage: " << prog << " [--emit-intermediate] [--via-files] [--emit-binary] [--via-binary] [--emit-xref]\n"
+              << "                 [--threads N] [--emit-object [--no-listing] [--collapse-ds]] [--time N] [input.txt | -]\n"
+#ifndef ASM_NO_STATS
+              << "                 [--stats FILE]\n"
+#endif
+              << "       " << prog << " --batch <dir | list.txt> [--threads N]\n"
+              << "       " << prog << " --serve SOCKET [--threads N] [--cache N]\n"
+              << "       " << prog << " --incremental CACHE [--emit-intermediate] [--emit-binary] [--emit-xref] [input.txt]\n"
+              << "       " << prog << " --one-pass [input.txt | -]\n"
+              << "       " << prog << " --who-references SYMBOL\n"
+              << "       " << prog << " --list-object output.obj [--base ADDR] [--collapse-ds]\n"
+              << "       " << prog << " --run <output.obj | output.txt> [--input FILE] [--max-steps N] [--base ADDR]\n"
+              << "  --emit-intermediate  also write intermediate.txt, symbol_table.txt, literal_table.txt\n"
+              << "  --via-files          run pass2 from the text files instead of pass1's tables\n"
+              << "  --emit-binary        also write the binary IC file intermediate.bin\n"
+              << "  --via-binary         run pass2 from a memory-mapped intermediate.bin\n"
+              << "  --emit-xref          also write xref.bin, every symbol's definitions and uses (not with --one-pass)\n"
+              << "  --who-references S   list the definitions and uses of symbol S from xref.bin\n"
+              << "  --threads N          run pass 1 and pass 2 on N threads (0 = one per core)\n"
+              << "  --batch PATH         assemble every .asm in a directory (or listed in a file),\n"
+              << "                       writing <name>.out next to each; N jobs run at once\n"
+              << "  --serve SOCKET       run as a daemon on a Unix socket: N workers with warm contexts,\n"
+              << "                       the last --cache N results (default 256) kept by source\n"
+              << "  --incremental CACHE  reassemble only the lines changed since the run that wrote CACHE\n"
+              << "  --one-pass           assemble in a single pass, backpatching forward references\n"
+              << "  --emit-object        write the relocatable object output.obj; output.txt is listed from it\n"
+              << "  --no-listing         write only output.obj (implies --emit-object)\n"
+              << "  --collapse-ds        list each DS range as one '+00 0 0000 x<words>' line (implies --emit-object)\n"
+              << "  --list-object FILE   load an object file (at ADDR with --base) and write its listing\n"
+              << "  --run FILE           execute an object file or listing; READ takes integers from --input\n"
+              << "                       (default stdin), PRINT goes to stdout, the report to stderr\n"
+              << "  --max-steps N        stop --run after about N instructions (checked at taken branches)\n"
+              << "  --time N             assemble N times with each pipeline and compare timings\n"
+#ifndef ASM_NO_STATS
+              << "  --stats FILE         time pass 1's phases (serially), count lines, symbols, forward\n"
+              << "                       references, pools and MOT lookups, and write them as JSON\n"
+#endif
+              ;
+}
+
+static bool parseArgs(int argc, char** argv, Options& opt) {
+    for (int i = 1; i < argc; ++i) {
+        std::string a = argv[i];
+        if (a == "--emit-intermediate") opt.emitIntermediate = true;
+        else if (a == "--via-files") opt.viaFiles = opt.emitIntermediate = true;
+        else if (a == "--emit-binary") opt.emitBinary = true;
+        else if (a == "--via-binary") opt.viaBinary = opt.emitBinary = true;
+        else if (a == "--emit-xref") opt.emitXref = true;
+        else if (a == "--who-references" && i + 1 < argc) opt.whoReferences = argv[++i];
+        else if (a == "--batch" && i + 1 < argc) opt.batch = argv[++i];
+        else if (a == "--serve" && i + 1 < argc) opt.serve = argv[++i];
+        else if (a == "--cache" && i + 1 < argc) opt.cacheEntries = std::strtoull(argv[++i], nullptr, 10);
+        else if (a == "--incremental" && i + 1 < argc) opt.cacheFile = argv[++i];
+        else if (a == "--emit-object") opt.emitObject = true;
+        else if (a == "--one-pass") opt.onePass = true;
+        else if (a == "--no-listing") { opt.listing = false; opt.emitObject = true; }
+        else if (a == "--collapse-ds") opt.collapseDS = opt.emitObject = true;
+        else if (a == "--list-object" && i + 1 < argc) opt.listObject = argv[++i];
+        else if (a == "--run" && i + 1 < argc) opt.runFile = argv[++i];
+        else if (a == "--input" && i + 1 < argc) opt.runInput = argv[++i];
+        else if (a == "--max-steps" && i + 1 < argc) opt.maxSteps = std::strtoull(argv[++i], nullptr, 10);
+        else if (a == "--base" && i + 1 < argc) {
+            long long b = std::atoll(argv[++i]);
+            if (b < 0 || b >= ADDRESS_END) return false;
+            opt.rebase = true;
+            opt.base = (Address)b;
+        }
+        else if (a == "--time" && i + 1 < argc) opt.timeRuns = std::atoi(argv[++i]);
+#ifndef ASM_NO_STATS
+        else if (a == "--stats" && i + 1 < argc) opt.statsFile = argv[++i];
+#endif
+        else if (a == "--threads" && i + 1 < argc) {
+            int n = std::atoi(argv[++i]);
+            if (n < 0) return false;
+            opt.threads = n ? (unsigned)n : std::max(1u, std::thread::hardware_concurrency());
+        }
+        else if (a.size() > 1 && a[0] == '-') return false;
+        else opt.inputFile = a;
+    }
+    return !(opt.onePass && opt.emitXref);   // one-pass keeps no IC to index
+}
+
+// Runs each pipeline `timeRuns` times on the same source and prints average wall time per run.
+static int comparePipelines(const Options& opt,
+                            const std::string& intermediateFile, const std::string& symbolFile,
+                            const std::string& literalFile, const std::string& binaryFile,
+                            const std::string& objectFile, const std::string& outputFile) {
+    using Clock = std::chrono::steady_clock;
+    auto ms = [](Clock::duration d) { return std::chrono::duration<double, std::milli>(d).count(); };
+
+    Clock::duration viaFiles{}, inProcess{}, viaBinary{}, viaObject{}, onePass{};
+    for (int r = 0; r < opt.timeRuns; ++r) {
+        auto t0 = Clock::now();
+        {
+            AssemblerData p1; initializeTables(p1);
+            if (!pass1(opt.inputFile, p1, opt.threads)) return 1;
+            writePass1Outputs(p1, intermediateFile, symbolFile, literalFile);
+            AssemblerData p2; initializeTables(p2);
+            loadPass1Outputs(intermediateFile, symbolFile, literalFile, p2);
+            pass2(p2, outputFile, opt.threads);
+        }
+        auto t1 = Clock::now();
+        {
+            AssemblerData d; initializeTables(d);
+            if (!pass1(opt.inputFile, d, opt.threads)) return 1;
+            pass2(d, outputFile, opt.threads);
+        }
+        auto t2 = Clock::now();
+        {
+            AssemblerData d; initializeTables(d);
+            if (!pass1(opt.inputFile, d, opt.threads)) return 1;
+            writeBinaryIC(d, binaryFile);
+            pass2FromBinary(binaryFile, outputFile, opt.threads);
+        }
+        auto t3 = Clock::now();
+        {
+            AssemblerData d; initializeTables(d);
+            if (!pass1(opt.inputFile, d, opt.threads)) return 1;
+            ObjectModule obj;
+            buildObject(d, obj);
+            writeObject(obj, objectFile);
+            ObjectFile file; std::string error;
+            if (!file.open(objectFile, error) || !file.relocate(file.header().origin, obj, error)) {
+                std::cerr << "Error: " << error << "\n";
+                return 1;
+            }
+            writeListing(obj, outputFile);
+        }
+        auto t4 = Clock::now();
+        {
+            AssemblerData d; initializeTables(d);
+            std::string listing;
+            OnePassStats stats;
+            if (!assembleOnePass(opt.inputFile, d, listing, stats)) return 1;
+            std::ofstream out(outputFile, std::ios::binary);
+            out.write(listing.data(), (std::streamsize)listing.size());
+        }
+        auto t5 = Clock::now();
+        viaFiles += t1 - t0;
+        inProcess += t2 - t1;
+        viaBinary += t3 - t2;
+        viaObject += t4 - t3;
+        onePass += t5 - t4;
+    }
+
+    double a = ms(viaFiles) / opt.timeRuns, b = ms(inProcess) / opt.timeRuns, c = ms(viaBinary) / opt.timeRuns;
+    double o = ms(viaObject) / opt.timeRuns, p = ms(onePass) / opt.timeRuns;
+    std::cout << std::fixed << std::setprecision(3)
+              << "Runs: " << opt.timeRuns << " (" << opt.inputFile << ", " << opt.threads << " thread(s))\n"
+              << std::left << std::setw(28) << "  text round trip (ms/run)" << a << "\n"
+              << std::setw(28) << "  binary IC (ms/run)" << c << "\n"
+              << std::setw(28) << "  in-process (ms/run)" << b << "\n"
+              << std::setw(28) << "  object + listing (ms/run)" << o << "\n"
+              << std::setw(28) << "  one pass (ms/run)" << p << "\n"
+              << std::setw(28) << "  speedup" << (b > 0 ? a / b : 0.0) << "x\n";
+    return 0;
+}
+
+// Maps an object file, relocates it (to --base if given) and writes its listing
+static int runListObject(const Options& opt, const std::string& outputFile) {
+    using Clock = std::chrono::steady_clock;
+    auto t0 = Clock::now();
+    ObjectFile file;
+    std::string error;
+    if (!file.open(opt.listObject, error)) {
+        std::cerr << "Error: " << error << "\n";
+        return 1;
+    }
+    ObjectModule obj;
+    if (!file.relocate(opt.rebase ? opt.base : file.header().origin, obj, error)) {
+        std::cerr << "Error: " << opt.listObject << ": " << error << "\n";
+        return 1;
+    }
+    double loadMs = std::chrono::duration<double, std::milli>(Clock::now() - t0).count();
+    if (!writeListing(obj, outputFile, opt.collapseDS)) return 1;
+
+    long long reserved = 0;
+    for (const ObjRun& run : obj.runs)
+        if (run.kind == ObjRunKind::RESERVE) reserved += run.wordCount;
+
+    std::cout << std::fixed << std::setprecision(3)
+              << "Object: " << opt.listObject << " (" << obj.words.size() << " words + " << reserved
+              << " zero-filled, " << obj.runs.size() << " runs in " << obj.segments.size() << " segment(s), " << obj.relocations.size() << " relocations)\n"
+              << "  assembled at " << file.header().origin << ", loaded at " << obj.origin
+              << " in " << loadMs << " ms\n"
+              << "Listing: " << outputFile << "\n";
+    return 0;
+}
+
+// Loads an object file or listing into the VM, runs it and reports instructions/sec on stderr
+static int runProgram(const Options& opt) {
+    using Clock = std::chrono::steady_clock;
+    auto t0 = Clock::now();
+    VirtualMachine vm;
+    std::string error;
+    if (!vm.load(opt.runFile, error, opt.rebase, opt.base)) {
+        std::cerr << "Error: " << error << "\n";
+        return 1;
+    }
+    double loadMs = std::chrono::duration<double, std::milli>(Clock::now() - t0).count();
+
+    std::FILE* in = opt.runInput == "-" ? stdin : std::fopen(opt.runInput.c_str(), "rb");
+    if (!in) {
+        std::cerr << "Error: Cannot open " << opt.runInput << "\n";
+        return 1;
+    }
+    const VmResult r = vm.run(in, stdout, opt.maxSteps);
+    if (in != stdin) std::fclose(in);
+
+    static const char* const stops[] = {"STOP", "fault", "step limit"};
+    std::cerr << std::fixed << std::setprecision(3)
+              << "Run: " << opt.runFile << " (" << vm.wordsLoaded() << " words, entry " << vm.entry()
+              << ", loaded in " << loadMs << " ms)\n"
+              << "  stopped:        " << stops[(int)r.stop] << " at " << r.address
+              << (r.message.empty() ? "" : ": " + r.message) << "\n"
+              << "  instructions:   " << r.steps << "\n"
+              << "  time (ms):      " << r.seconds * 1000 << "\n"
+              << "  instructions/s: " << std::setprecision(0) << (r.seconds > 0 ? r.steps / r.seconds : 0.0) << "\n"
+              << "  AREG " << r.registers[0] << "  BREG " << r.registers[1]
+              << "  CREG " << r.registers[2] << "  DREG " << r.registers[3] << "\n";
+    return r.stop == VmStop::STOP ? 0 : 1;
+}
+
+// Maps xref.bin and lists every definition and use of one symbol
+static int runXrefQuery(const Options& opt, const std::string& xrefFile) {
+    using Clock = std::chrono::steady_clock;
+    auto t0 = Clock::now();
+    XrefFile index;
+    std::string error;
+    if (!index.open(xrefFile, error)) {
+        std::cerr << "Error: " << error << "\n";
+        return 1;
+    }
+    auto t1 = Clock::now();
+    const std::int64_t id = index.find(opt.whoReferences);
+    auto t2 = Clock::now();
+    if (id < 0) {
+        std::cerr << "Error: Symbol '" << opt.whoReferences << "' is not in " << xrefFile << "\n";
+        return 1;
+    }
+
+    const std::uint32_t sym = (std::uint32_t)id;
+    std::cout << "Symbol: " << index.symbolName(sym) << " (address " << printedAddress(index.symbolAddress(sym)) << ")\n"
+              << std::left << std::setw(10) << "  Line" << std::setw(10) << "IC" << "Use\n";
+    for (const XrefEntry* r = index.refsBegin(sym); r != index.refsEnd(sym); ++r)
+        std::cout << "  " << std::setw(8) << r->line << std::setw(10) << r->ic
+                  << referenceKindName((ReferenceKind)r->kind) << "\n";
+    auto ms = [](Clock::duration d) { return std::chrono::duration<double, std::milli>(d).count(); };
+    std::cout << std::fixed << std::setprecision(3)
+              << index.refsEnd(sym) - index.refsBegin(sym) << " reference(s); " << xrefFile << ": "
+              << index.header().symbolCount << " symbols, " << index.header().refCount << " references, mapped in "
+              << ms(t1 - t0) << " ms, lookup " << ms(t2 - t1) * 1000 << " us\n";
+    return 0;
+}
+
+// One-pass assembly: writes output.txt and reports how many forward references were backpatched
+static int runOnePass(const Options& opt, const std::string& outputFile) {
+    using Clock = std::chrono::steady_clock;
+    auto t0 = Clock::now();
+    std::pmr::monotonic_buffer_resource arena;
+    AssemblerData data(&arena); initializeTables(data);
+    std::string listing;
+    OnePassStats stats;
+    if (!assembleOnePass(opt.inputFile, data, listing, stats)) return 1;
+    if (!data.errors.empty()) {
+        displayErrors(data);
+        std::cout << "\nAssembly failed with errors. No machine code written.\n";
+        return 1;
+    }
+    std::ofstream out(outputFile, std::ios::binary);
+    if (!out.write(listing.data(), (std::streamsize)listing.size())) {
+        std::cerr << "Error: Cannot create " << outputFile << "\n";
+        return 1;
+    }
+    out.close();
+    double ms = std::chrono::duration<double, std::milli>(Clock::now() - t0).count();
+
+    std::cout << std::fixed << std::setprecision(3)
+              << "One pass: " << stats.words << " instructions, " << stats.forwardRefs << " forward references\n"
+              << "  backpatched at definition: " << stats.patchedEarly << "\n"
+              << "  backpatched after END:     " << stats.patchedAtEnd << "\n"
+              << "  time (ms):                 " << ms << "\n"
+              << "Machine code: " << outputFile << "\n";
+    return 0;
+}
+
+// Incremental reassembly: writes output.txt (and any requested tables) and reports the work saved
+static int runIncremental(const Options& opt,
+                          const std::string& intermediateFile, const std::string& symbolFile,
+                          const std::string& literalFile, const std::string& binaryFile,
+                          const std::string& xrefFile, const std::string& outputFile) {
+    using Clock = std::chrono::steady_clock;
+    auto t0 = Clock::now();
+    std::pmr::monotonic_buffer_resource arena;   // all of this run's tables, released at exit
+    AssemblerData data(&arena); initializeTables(data);
+    data.crossReference = opt.emitXref;
+    IncrementalRun run;
+    if (!assembleIncremental(opt.inputFile, opt.cacheFile, outputFile, data, run)) return 1;
+    double ms = std::chrono::duration<double, std::milli>(Clock::now() - t0).count();
+
+    if (opt.emitIntermediate) writePass1Outputs(data, intermediateFile, symbolFile, literalFile);
+    if (opt.emitBinary && !writeBinaryIC(data, binaryFile)) return 1;
+    if (opt.emitXref && !writeXref(data, xrefFile)) return 1;
+    if (!data.errors.empty()) {
+        displayErrors(data);
+        std::cout << "\nPass 1 completed with errors. Cannot proceed to Pass 2 (cache not updated).\n";
+        return 1;
+    }
+
+    std::cout << std::fixed << std::setprecision(3)
+              << "Incremental: " << (run.cacheUsed ? "cache " + opt.cacheFile : std::string("no usable cache")) << "\n"
+              << "  lines reprocessed:       " << run.reprocessed << " of " << run.lines.size()
+              << " (" << run.changed << " changed)\n"
+              << "  machine code rebuilt:    " << run.regenerated << " of " << run.codeLines << " lines\n"
+              << "  time (ms):               " << ms << "\n"
+              << "Machine code: " << outputFile << "\n";
+    return 0;
+}
+
+int main(int argc, char** argv) {
+    Options opt;
+    if (!parseArgs(argc, argv, opt)) { usage(argv[0]); return 2; }
+
+    if (!opt.batch.empty()) return runBatch(opt.batch, opt.threads);
+
+    if (!opt.serve.empty()) return runServer(opt.serve, opt.threads, opt.cacheEntries);
 
-int main() {
-    std::string inputFile        = "input.txt";
     std::string intermediateFile = "intermediate.txt";
     std::string symbolFile       = "symbol_table.txt";
     std::string literalFile      = "literal_table.txt";
+    std::string binaryFile       = "intermediate.bin";
+    std::string objectFile       = "output.obj";
+    std::string xrefFile         = "xref.bin";
     std::string outputFile       = "output.txt";
 
+    if (!opt.listObject.empty()) return runListObject(opt, outputFile);
+
+    if (!opt.runFile.empty()) return runProgram(opt);
+
+    if (!opt.whoReferences.empty()) return runXrefQuery(opt, xrefFile);
+
+    if (!opt.cacheFile.empty())
+        return runIncremental(opt, intermediateFile, symbolFile, literalFile, binaryFile, xrefFile, outputFile);
+
+    if (opt.onePass) return runOnePass(opt, outputFile);
+
+    if (opt.timeRuns > 0)
+        return comparePipelines(opt, intermediateFile, symbolFile, literalFile, binaryFile, objectFile, outputFile);
+
     std::cout << std::string(70,'=') << "\n"
               << "     TWO-PASS ASSEMBLER FOR PSEUDO MACHINE\n"
               << std::string(70,'=') << "\n";
 
-    displaySourceCode(inputFile);
+    if (opt.inputFile != "-") displaySourceCode(opt.inputFile); // stdin can only be read once
 
     std::cout << "\n" << std::string(70,'=') << "\nEXECUTING PASS 1\n" << std::string(70,'=') << "\n";
-    AssemblerData pass1Data; initializeTables(pass1Data);
-    pass1(inputFile, intermediateFile, symbolFile, literalFile, pass1Data);
+    // Both passes' tables come from one arena, released in one go on return
+    std::pmr::monotonic_buffer_resource arena;
+    AssemblerData pass1Data(&arena); initializeTables(pass1Data);
+    pass1Data.crossReference = opt.emitXref;
+#ifndef ASM_NO_STATS
+    Pass1Stats stats;
+    if (!opt.statsFile.empty()) pass1Data.stats = &stats;
+    auto writeStats = [&] { return opt.statsFile.empty() || writeStatsJson(stats, pass1Data, opt.statsFile); };
+#else
+    auto writeStats = [] { return true; };
+#endif
+
+    if (!pass1(opt.inputFile, pass1Data, opt.threads)) return 1;
+    std::cout << "PASS 1 COMPLETED\n";
+#ifndef ASM_NO_STATS
+    auto phase = std::chrono::steady_clock::now();
+#endif
+    if (opt.emitIntermediate) {
+        writePass1Outputs(pass1Data, intermediateFile, symbolFile, literalFile);
+        std::cout << "Intermediate: " << intermediateFile << "\n"
+                  << "Symbols: " << symbolFile << "\n"
+                  << "Literals: " << literalFile << "\n";
+    }
+    if (opt.emitBinary && !writeBinaryIC(pass1Data, binaryFile)) return 1;
+    if (opt.emitXref && !writeXref(pass1Data, xrefFile)) return 1;
+#ifndef ASM_NO_STATS
+    stats.writeMs = msSince(phase);
+#endif
     displaySymbolTable(pass1Data);
     displayLiteralTable(pass1Data);
+    displayPoolTable(pass1Data);
+    displaySegmentMap(pass1Data);
     displayIntermediateCode(pass1Data);
     displayErrors(pass1Data);
 
     if (!pass1Data.errors.empty()) {
         std::cout << "\nPass 1 completed with errors. Cannot proceed to Pass 2.\n";
+        writeStats();
         return 1;
     }
 
     std::cout << "\n" << std::string(70,'=') << "\nEXECUTING PASS 2\n" << std::string(70,'=') << "\n";
-    AssemblerData pass2Data; initializeTables(pass2Data);
-    pass2(intermediateFile, symbolFile, literalFile, outputFile, pass2Data);
+#ifndef ASM_NO_STATS
+    phase = std::chrono::steady_clock::now();
+#endif
+    if (opt.viaFiles) {
+        AssemblerData pass2Data(&arena); initializeTables(pass2Data);
+        pass2(intermediateFile, symbolFile, literalFile, outputFile, pass2Data, opt.threads);
+    } else if (opt.viaBinary) {
+        if (!pass2FromBinary(binaryFile, outputFile, opt.threads)) return 1;
+        std::cout << "PASS 2 COMPLETED\nMachine code: " << outputFile << "\n";
+    } else if (opt.emitObject) {
+        ObjectModule obj;
+        buildObject(pass1Data, obj);
+        if (!writeObject(obj, objectFile)) return 1;
+        if (opt.listing && !writeListing(obj, outputFile, opt.collapseDS)) return 1;
+        std::cout << "PASS 2 COMPLETED\nObject: " << objectFile << " (" << obj.words.size() << " words, "
+                  << obj.relocations.size() << " relocations)\n";
+        if (opt.listing) std::cout << "Machine code: " << outputFile << "\n";
+    } else {
+        if (!pass2(pass1Data, outputFile, opt.threads)) return 1;
+        std::cout << "PASS 2 COMPLETED\nMachine code: " << outputFile << "\n";
+    }
+#ifndef ASM_NO_STATS
+    stats.pass2Ms = msSince(phase);
+#endif
+    if (!writeStats()) return 1;
 
-    displayMachineCode(outputFile);
+    if (opt.listing) displayMachineCode(outputFile);
 
     std::cout << "\n" << std::string(70,'=') << "\nASSEMBLY COMPLETED SUCCESSFULLY\n" << std::string(70,'=') << "\n"
-              << "\nFiles Generated:\n"
-              << "  - " << intermediateFile << " (Intermediate Code)\n"
-              << "  - " << symbolFile       << " (Symbol Table)\n"
-              << "  - " << literalFile      << " (Literal Table)\n"
-              << "  - " << outputFile       << " (Machine Code)\n";
+              << "\nFiles Generated:\n";
+    if (opt.emitIntermediate)
+        std::cout << "  - " << intermediateFile << " (Intermediate Code)\n"
+                  << "  - " << symbolFile       << " (Symbol Table)\n"
+                  << "  - " << literalFile      << " (Literal Table)\n";
+    if (opt.emitBinary)
+        std::cout << "  - " << binaryFile << " (Binary Intermediate Code)\n";
+    if (opt.emitXref)
+        std::cout << "  - " << xrefFile << " (Cross-Reference Index)\n";
+    if (opt.emitObject)
+        std::cout << "  - " << objectFile << " (Relocatable Object)\n";
+    if (opt.listing)
+        std::cout << "  - " << outputFile << " (Machine Code)\n";
+#ifndef ASM_NO_STATS
+    if (!opt.statsFile.empty())
+        std::cout << "  - " << opt.statsFile << " (Pass 1 Statistics)\n";
+#endif
     return 0;
 }
@@ -0,0 +1,216 @@
+// objfile.cpp — object file writer, mmap loader and listing view (see objfile.hpp)
+
+#include "objfile.hpp"
+#include "../../common/format_int.hpp"
+#include <cstring>
+#include <fstream>
+#include <iostream>
+
+using std::string;
+
+template <typename T>
+static void writeArray(std::ofstream& out, const std::vector<T>& v) {
+    if (!v.empty()) out.write(reinterpret_cast<const char*>(v.data()), (std::streamsize)(v.size() * sizeof(T)));
+}
+
+bool writeObject(const ObjectModule& obj, const string& objectFile) {
+    std::ofstream out(objectFile, std::ios::binary);
+    if (!out.is_open()) {
+        std::cerr << "Error: Cannot create " << objectFile << "\n";
+        return false;
+    }
+
+    string strings;
+    std::vector<std::uint32_t> symName;
+    for (const string& name : obj.symbolName) {
+        symName.push_back((std::uint32_t)strings.size());
+        strings += name;
+    }
+    symName.push_back((std::uint32_t)strings.size());
+    strings.resize((strings.size() + 3) & ~size_t(3), '\0'); // keep the file 4-byte aligned
+
+    ObjHeader h{};
+    std::memcpy(h.magic, OBJECT_MAGIC, sizeof h.magic);
+    h.version     = OBJECT_VERSION;
+    h.wordSize    = sizeof(ObjWord);
+    h.origin      = obj.origin;
+    h.wordCount   = (std::uint32_t)obj.words.size();
+    h.runCount    = (std::uint32_t)obj.runs.size();
+    h.segmentCount = (std::uint32_t)obj.segments.size();
+    h.relocCount  = (std::uint32_t)obj.relocations.size();
+    h.symbolCount = (std::uint32_t)obj.symbolAddress.size();
+    h.stringBytes = (std::uint32_t)strings.size();
+
+    out.write(reinterpret_cast<const char*>(&h), sizeof h);
+    writeArray(out, obj.words);
+    writeArray(out, obj.runs);
+    writeArray(out, obj.segments);
+    writeArray(out, obj.relocations);
+    writeArray(out, obj.symbolAddress);
+    writeArray(out, obj.symbolLength);
+    writeArray(out, obj.symbolFlags);
+    writeArray(out, symName);
+    out.write(strings.data(), (std::streamsize)strings.size());
+    return (bool)out;
+}
+
+// True if `count + 1` offsets never decrease and end at or before `limit`
+static bool offsetsValid(const std::uint32_t* offset, std::uint32_t count, std::uint32_t limit) {
+    for (std::uint32_t i = 0; i < count; ++i)
+        if (offset[i] > offset[i + 1]) return false;
+    return offset[count] <= limit;
+}
+
+bool ObjectFile::open(const string& path, string& error) {
+    if (!file_.open(path)) { error = "Cannot open " + path; return false; }
+    if (file_.size() < sizeof(ObjHeader)) { error = path + ": truncated header"; return false; }
+
+    hdr_ = reinterpret_cast<const ObjHeader*>(file_.data());
+    if (std::memcmp(hdr_->magic, OBJECT_MAGIC, sizeof hdr_->magic) != 0) { error = path + ": not an object file"; return false; }
+    if (hdr_->version != OBJECT_VERSION || hdr_->wordSize != sizeof(ObjWord)) {
+        error = path + ": unsupported object file version";
+        return false;
+    }
+
+    const std::uint64_t need = sizeof(ObjHeader)
+        + (std::uint64_t)hdr_->wordCount * sizeof(ObjWord)
+        + (std::uint64_t)hdr_->runCount * sizeof(ObjRun)
+        + (std::uint64_t)hdr_->segmentCount * sizeof(Segment)
+        + (std::uint64_t)hdr_->relocCount * sizeof(ObjRelocation)
+        + (std::uint64_t)hdr_->symbolCount * 16 + 4
+        + hdr_->stringBytes;
+    if (file_.size() < need) { error = path + ": truncated file"; return false; }
+
+    const char* p = file_.data() + sizeof(ObjHeader);
+    auto take = [&p](std::uint64_t bytes) { const char* q = p; p += bytes; return q; };
+    words_   = reinterpret_cast<const ObjWord*>(take((std::uint64_t)hdr_->wordCount * sizeof(ObjWord)));
+    runs_    = reinterpret_cast<const ObjRun*>(take((std::uint64_t)hdr_->runCount * sizeof(ObjRun)));
+    segs_    = reinterpret_cast<const Segment*>(take((std::uint64_t)hdr_->segmentCount * sizeof(Segment)));
+    relocs_  = reinterpret_cast<const ObjRelocation*>(take((std::uint64_t)hdr_->relocCount * sizeof(ObjRelocation)));
+    symAddr_ = reinterpret_cast<const Address*>(take((std::uint64_t)hdr_->symbolCount * 4));
+    symLen_  = reinterpret_cast<const std::int32_t*>(take((std::uint64_t)hdr_->symbolCount * 4));
+    symFlags_ = reinterpret_cast<const std::uint32_t*>(take((std::uint64_t)hdr_->symbolCount * 4));
+    symName_ = reinterpret_cast<const std::uint32_t*>(take(((std::uint64_t)hdr_->symbolCount + 1) * 4));
+    strings_ = take(hdr_->stringBytes);
+
+    // The loader trusts these when relocating, so check them once here
+    for (std::uint32_t r = 0; r < hdr_->runCount; ++r) {
+        if ((runs_[r].kind != ObjRunKind::RESERVE &&
+             (std::uint64_t)runs_[r].firstWord + runs_[r].wordCount > hdr_->wordCount) ||
+            (std::int64_t)runs_[r].address + runs_[r].wordCount > ADDRESS_END) {
+            error = path + ": run " + std::to_string(r) + " is out of range";
+            return false;
+        }
+    }
+    for (std::uint32_t r = 0; r < hdr_->relocCount; ++r) {
+        if (relocs_[r].word >= hdr_->wordCount || (r > 0 && relocs_[r].word <= relocs_[r - 1].word)) {
+            error = path + ": relocation " + std::to_string(r) + " is out of range or order";
+            return false;
+        }
+    }
+    if (!offsetsValid(symName_, hdr_->symbolCount, hdr_->stringBytes)) {
+        error = path + ": inconsistent tables";
+        return false;
+    }
+    return true;
+}
+
+std::string_view ObjectFile::symbolName(std::uint32_t id) const {
+    return std::string_view(strings_ + symName_[id], symName_[id + 1] - symName_[id]);
+}
+
+bool ObjectFile::relocate(Address base, ObjectModule& out, string& error) const {
+    // Addresses move by `delta` modulo 2^32; the segments say whether that wraps
+    const std::int64_t shift = (std::int64_t)base - hdr_->origin;
+    for (std::uint32_t i = 0; i < hdr_->segmentCount; ++i) {
+        const std::int64_t from = segs_[i].base + shift, to = from + segs_[i].length;
+        if (from < 0 || to > ADDRESS_END) {
+            error = "segment " + std::to_string(segs_[i].base) + "+" + std::to_string(segs_[i].length) +
+                    " does not fit the 32-bit address space at base " + std::to_string(base);
+            return false;
+        }
+    }
+    const Address delta = (Address)shift;
+    out.origin = base;
+
+    // Words and relocations are both in word order: one sweep applies them all
+    const std::uint32_t nword = hdr_->wordCount, nreloc = hdr_->relocCount;
+    out.words.resize(nword);
+    for (std::uint32_t w = 0, r = 0; w < nword; ++w) {
+        out.words[w] = words_[w];
+        if (r < nreloc && relocs_[r].word == w) {
+            out.words[w].operand = (std::int32_t)((Address)out.words[w].operand + delta);
+            ++r;
+        }
+    }
+
+    out.runs.assign(runs_, runs_ + hdr_->runCount);
+    for (ObjRun& run : out.runs) run.address += delta;
+    out.segments.assign(segs_, segs_ + hdr_->segmentCount);
+    for (Segment& seg : out.segments) seg.base += delta;
+    out.relocations.assign(relocs_, relocs_ + nreloc);
+
+    out.symbolAddress.resize(hdr_->symbolCount);
+    out.symbolName.resize(hdr_->symbolCount);
+    for (std::uint32_t id = 0; id < hdr_->symbolCount; ++id) {
+        out.symbolAddress[id] = symAddr_[id] + (symFlags_[id] & (OBJ_SYMBOL_ABSOLUTE | OBJ_SYMBOL_UNDEFINED) ? 0 : delta);
+        out.symbolName[id] = string(symbolName(id));
+    }
+    out.symbolLength.assign(symLen_, symLen_ + hdr_->symbolCount);
+    out.symbolFlags.assign(symFlags_, symFlags_ + hdr_->symbolCount);
+    return true;
+}
+
+static const char LISTING_HEADER[] = "ADDRESS  MACHINE CODE\n==============================\n";
+
+// Words are formatted into a buffer that is flushed every kFlushBytes
+static const size_t kFlushBytes = 1 << 20;
+
+void writeListing(const ObjectModule& obj, std::ostream& out, bool collapseReserve) {
+    out << LISTING_HEADER;
+    string buf;
+    for (const ObjRun& run : obj.runs) {
+        if (run.kind == ObjRunKind::RESERVE && (collapseReserve || run.wordCount == 0)) {
+            appendInt(buf, run.address, 4);
+            if (collapseReserve) {
+                buf += "     +00 0 0000 x";
+                appendInt(buf, run.wordCount);
+            } else {
+                buf += "     ";
+            }
+            buf += '\n';
+            continue;
+        }
+        for (std::uint32_t i = 0; i < run.wordCount; ++i) {
+            const ObjWord& w = wordAt(obj, run, i);
+            appendInt(buf, (long long)run.address + i, 4);
+            if (w.kind == ObjWordKind::INSTRUCTION) {
+                buf += "     +";
+                appendInt(buf, w.opcode, 2);
+                buf += ' ';
+                appendInt(buf, w.reg);
+                buf += ' ';
+                appendInt(buf, (Address)w.operand, 4);
+            } else {
+                buf += "     +00 0 ";
+                appendInt(buf, w.operand, 4);
+            }
+            buf += '\n';
+            if (buf.size() >= kFlushBytes) {
+                out.write(buf.data(), (std::streamsize)buf.size());
+                buf.clear();
+            }
+        }
+    }
+    out.write(buf.data(), (std::streamsize)buf.size());
+}
+
+bool writeListing(const ObjectModule& obj, const string& listingFile, bool collapseReserve) {
+    std::ofstream out(listingFile);
+    if (!out.is_open()) {
+        std::cerr << "Error: Cannot create " << listingFile << "\n";
+        return false;
+    }
+    writeListing(obj, out, collapseReserve);
+    return (bool)out;
+}
@@ -0,0 +1,152 @@
+#pragma once
+// objfile.hpp — relocatable object file (output.obj) written by Pass 2
+//
+// Layout (little-endian, 4-byte aligned, written in this order):
+//   ObjHeader
+//   ObjWord       words[wordCount]            machine words in listing order
+//   ObjRun        runs[runCount]              address ranges the words load at,
+//                                             or zero-filled ranges (DS)
+//   Segment       segments[segmentCount]      pass 1's segment map: populated address ranges
+//   ObjRelocation relocations[relocCount]     sorted by word index
+//   int32  symbolAddress[symbolCount]
+//   int32  symbolLength[symbolCount]
+//   uint32 symbolFlags[symbolCount]           OBJ_SYMBOL_* bits
+//   uint32 symbolNameOffset[symbolCount + 1]  into the string pool
+//   char   strings[stringBytes]
+//
+// Addresses in the file are those the program was assembled at (`origin`,
+// the START address). Loading at another base adds (base - origin) to every
+// run and segment address, every relocatable symbol and the address field of
+// every relocated word. An operand resolved through an absolute symbol (an
+// EQU constant) or an undefined one has no relocation record and stays put.
+// The segments tell the loader whether the image still fits the 32-bit
+// address space there. Only populated ranges are stored, so the file size
+// follows the code, not the distance between ORIGINs.
+#include <cstdint>
+#include <iosfwd>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "assembler.hpp"
+#include "../../common/mapped_file.hpp"
+
+constexpr char          OBJECT_MAGIC[8] = {'A','S','M','O','B','J','\0','\0'};
+constexpr std::uint32_t OBJECT_VERSION  = 5;
+
+constexpr std::uint32_t OBJ_SYMBOL_ABSOLUTE  = 1;  // value does not move with the load address
+constexpr std::uint32_t OBJ_SYMBOL_UNDEFINED = 2;  // never defined; its address is a placeholder
+
+struct ObjHeader {
+    char          magic[8];
+    std::uint32_t version;
+    std::uint32_t wordSize;        // sizeof(ObjWord)
+    std::uint32_t origin;          // address the program was assembled at
+    std::uint32_t wordCount;
+    std::uint32_t runCount;
+    std::uint32_t segmentCount;
+    std::uint32_t relocCount;
+    std::uint32_t symbolCount;
+    std::uint32_t stringBytes;
+    std::uint32_t reserved;
+};
+static_assert(sizeof(ObjHeader) == 48, "object header layout");
+static_assert(sizeof(Segment) == 12, "segment map layout");
+
+enum class ObjWordKind : std::uint8_t {
+    INSTRUCTION,   // +<opcode> <reg/cc> <address>
+    CONSTANT,      // DC or literal: +00 0 <value>
+    STORAGE        // zero word: +00 0 0000
+};
+
+struct ObjWord {
+    std::int32_t  operand{0};      // address field (IS, read as Address) or value (DC/literal)
+    std::uint8_t  opcode{0};
+    std::uint8_t  reg{0};          // register / condition code, 0 if absent
+    ObjWordKind   kind{ObjWordKind::STORAGE};
+    std::uint8_t  reserved{0};
+};
+static_assert(sizeof(ObjWord) == 8, "object word layout");
+
+enum class ObjRunKind : std::uint8_t {
+    WORDS,     // words[firstWord, firstWord + wordCount) load at address, address + 1, ...
+    RESERVE    // DS: wordCount zero words at address; nothing stored (firstWord unused)
+};
+
+// A RESERVE run of zero words is a DS that reserved nothing; it is kept so
+// the listing still shows its address.
+struct ObjRun {
+    Address       address;
+    std::uint32_t firstWord;
+    std::uint32_t wordCount;
+    ObjRunKind    kind;
+    std::uint8_t  reserved[3];
+};
+static_assert(sizeof(ObjRun) == 16, "object run layout");
+
+// The address field of words[word] is program-relative (resolved through a
+// relocatable symbol or a literal)
+struct ObjRelocation {
+    std::uint32_t word;
+    std::int32_t  symbol;          // symbol it was resolved through, -1 for a literal
+};
+
+// An object held in memory: what Pass 2 builds, and what the loader produces
+struct ObjectModule {
+    Address origin{0};
+    std::vector<ObjWord> words;
+    std::vector<ObjRun> runs;
+    std::vector<Segment> segments;
+    std::vector<ObjRelocation> relocations;
+    std::vector<Address> symbolAddress;        // by symbol ID
+    std::vector<std::int32_t> symbolLength;
+    std::vector<std::uint32_t> symbolFlags;    // OBJ_SYMBOL_* bits
+    std::vector<std::string> symbolName;
+};
+
+inline constexpr ObjWord ZERO_FILL_WORD{};
+
+// Word i of `run`; reserved ranges are expanded here, one word at a time
+inline const ObjWord& wordAt(const ObjectModule& obj, const ObjRun& run, std::uint32_t i) {
+    return run.kind == ObjRunKind::RESERVE ? ZERO_FILL_WORD : obj.words[run.firstWord + i];
+}
+
+// Read-only view over a mapped object file; all pointers point into the mapping.
+class ObjectFile {
+public:
+    bool open(const std::string& path, std::string& error);
+
+    const ObjHeader&     header() const { return *hdr_; }
+    const ObjWord*       words() const { return words_; }
+    const ObjRun*        runs() const { return runs_; }
+    const Segment*       segments() const { return segs_; }
+    const ObjRelocation* relocations() const { return relocs_; }
+    std::string_view     symbolName(std::uint32_t id) const;
+
+    // Copies the object into `out` relocated to `base`, in one pass over the words;
+    // false (with `error` set) if a segment would leave the address space there
+    bool relocate(Address base, ObjectModule& out, std::string& error) const;
+
+private:
+    MappedFile file_;
+    const ObjHeader*     hdr_ = nullptr;
+    const ObjWord*       words_ = nullptr;
+    const ObjRun*        runs_ = nullptr;
+    const Segment*       segs_ = nullptr;
+    const ObjRelocation* relocs_ = nullptr;
+    const Address*       symAddr_ = nullptr;
+    const std::int32_t*  symLen_ = nullptr;
+    const std::uint32_t* symFlags_ = nullptr;
+    const std::uint32_t* symName_ = nullptr;
+    const char*          strings_ = nullptr;
+};
+
+// pass2.cpp: machine code for pass1's tables as an object module
+void buildObject(const AssemblerData& data, ObjectModule& obj);
+
+bool writeObject(const ObjectModule& obj, const std::string& objectFile);
+
+// The text listing (output.txt format) of an object module. With `collapseReserve`
+// each DS range is one line, "<address>     +00 0 0000 x<words>", instead of a
+// line per word.
+void writeListing(const ObjectModule& obj, std::ostream& out, bool collapseReserve = false);
+bool writeListing(const ObjectModule& obj, const std::string& listingFile, bool collapseReserve = false);
@@ -0,0 +1,176 @@
+// onepass.cpp — one-pass assembly with backpatching (--one-pass)
+// Input   : the source file (or "-" for stdin)
+// Output  : the output.txt listing, in a caller-owned string
+// Depends : assembler.hpp (pass1Statement / pass1Finish, listing format)
+//
+// Each statement goes through pass 1 and its IC is turned into listing text
+// on the spot, then dropped; no IC table is kept and there is no second pass.
+// An instruction whose symbol or literal has no address yet is listed up to
+// its address field and entered in the table of incomplete instructions
+// (TII): one entry per such instruction, chained per symbol / literal. When
+// the label is defined, or LTORG/END places the literal pool, its chain is
+// walked and every entry gets the address. Whatever is still open after END
+// (EQUs resolved there, symbols never defined) takes its final table value,
+// exactly as pass2() would read it. The addresses are then spliced into the
+// listing in place, back to front, in one move of the text.
+
+#include "assembler.hpp"
+#include "../../common/format_int.hpp"
+#include "../../common/line_reader.hpp"
+#include <cstring>
+#include <iostream>
+#include <vector>
+
+using std::string;
+using std::string_view;
+
+namespace {
+
+// A TII entry: an IS line listed without its address
+struct Incomplete {
+    std::size_t at;         // listing offset where the address goes (just before the '\n')
+    std::int32_t next;      // next entry waiting on the same symbol / literal, or -1
+    Address address;
+};
+
+class OnePass {
+public:
+    OnePass(AssemblerData& data, string& listing, OnePassStats& stats)
+        : d_(data), text_(listing), stats_(stats) {}
+
+    void begin() {
+        text_.assign(MACHINE_CODE_HEADER);
+        tii_.clear();
+        symbolChain_.clear();
+        literalChain_.clear();
+        placed_ = 0;
+    }
+
+    void statement(string_view line, const asmscan::LineBits& bits, int lineNum) {
+        const SourceLine sl = lexSourceLine(line, bits, d_);
+        if (sl.mnemonic.empty()) return;
+        pass1Statement(sl, lineNum, d_);
+
+        for (const IntermediateCodeLine& ic : d_.intermediateCode) list(ic);
+        d_.intermediateCode.clear();
+
+        // A label defined on this line completes the instructions waiting on it
+        if (!sl.label.empty()) {
+            const std::uint32_t id = d_.symbolIds.find(sl.label);
+            if (id < symbolChain_.size() && d_.symbolTable[id].defined)
+                patch(symbolChain_[id], d_.symbolTable[id].address, stats_.patchedEarly);
+        }
+        // LTORG/END place literals in table order
+        for (; placed_ < d_.literalTable.size() && d_.literalTable[placed_].address != NO_ADDRESS; ++placed_)
+            if (placed_ < literalChain_.size())
+                patch(literalChain_[placed_], d_.literalTable[placed_].address, stats_.patchedEarly);
+    }
+
+    void finish() {
+        pass1Finish(d_);
+        for (std::size_t id = 0; id < symbolChain_.size(); ++id)
+            patch(symbolChain_[id], d_.symbolTable[id].address, stats_.patchedAtEnd);
+        for (std::size_t i = 0; i < literalChain_.size(); ++i)
+            patch(literalChain_[i], d_.literalTable[i].address, stats_.patchedAtEnd);
+        splice();
+        for (const LiteralTableEntry& L : d_.literalTable)
+            if (L.address != NO_ADDRESS) formatLiteralWord(L.address, L.value, text_);
+    }
+
+private:
+    void list(const IntermediateCodeLine& ic) {
+        if (!formatListingHead(ic, text_)) return;
+        ++stats_.words;
+
+        Address address = 0;    // no second operand
+        const std::int32_t idx = ic.operand2Value;
+        if (ic.operand2Type == OperandKind::S) {
+            const SymbolTableEntry& e = d_.symbolTable[idx];
+            if (!e.defined) { defer(symbolChain_, idx); return; }
+            address = e.address;
+        } else if (ic.operand2Type == OperandKind::L) {
+            address = d_.literalTable[idx].address;
+            if (address == NO_ADDRESS) { defer(literalChain_, idx); return; }
+        }
+        appendInt(text_, address, 4);
+        text_ += '\n';
+    }
+
+    // Lists the line's end without its address and chains it on `index`
+    void defer(std::vector<std::int32_t>& chains, std::int32_t index) {
+        if ((std::size_t)index >= chains.size()) chains.resize((std::size_t)index + 1, -1);
+        tii_.push_back(Incomplete{text_.size(), chains[index], NO_ADDRESS});
+        chains[index] = (std::int32_t)tii_.size() - 1;
+        text_ += '\n';
+        ++stats_.forwardRefs;
+    }
+
+    void patch(std::int32_t& head, Address address, std::size_t& count) {
+        for (std::int32_t i = head; i >= 0; i = tii_[i].next) {
+            tii_[i].address = address;
+            ++count;
+        }
+        head = -1;
+    }
+
+    // Inserts every entry's address at its offset: the text grows once and
+    // each stretch between two entries moves once, last stretch first
+    void splice() {
+        if (tii_.empty()) return;
+        std::size_t grow = 0;
+        for (const Incomplete& t : tii_) grow += digits(t.address);
+        std::size_t src = text_.size(), dst = src + grow;
+        text_.resize(dst);
+        for (std::size_t i = tii_.size(); i-- > 0;) {
+            const std::size_t n = src - tii_[i].at;
+            src -= n;
+            dst -= n;
+            std::memmove(&text_[dst], &text_[src], n);
+            digits_.clear();
+            appendInt(digits_, tii_[i].address, 4);
+            dst -= digits_.size();
+            std::memcpy(&text_[dst], digits_.data(), digits_.size());
+        }
+    }
+
+    static std::size_t digits(Address a) {
+        std::size_t n = 1;
+        for (; a >= 10; a /= 10) ++n;
+        return n < 4 ? 4 : n;
+    }
+
+    AssemblerData& d_;
+    string& text_;
+    OnePassStats& stats_;
+    std::vector<Incomplete> tii_;
+    std::vector<std::int32_t> symbolChain_;     // symbol ID -> newest TII entry waiting on it, or -1
+    std::vector<std::int32_t> literalChain_;    // literal index -> newest TII entry, or -1
+    std::size_t placed_ = 0;                    // literals before this index have addresses
+    string digits_;
+};
+
+} // namespace
+
+/**
+ * One-pass assembly: pass 1 with the listing written as it goes
+ * @param inputFile Path to the source assembly file ("-" for stdin)
+ * @param data Reference to assembler data structure (tables filled; IC left empty)
+ * @param listing Receives the output.txt text, valid if data.errors is empty
+ * @param stats Counts of listed words and backpatched forward references
+ * @return false if the source file could not be opened
+ */
+bool assembleOnePass(const std::string& inputFile, AssemblerData& data, std::string& listing,
+                     OnePassStats& stats) {
+    LineReader in;
+    if (!in.open(inputFile)) {
+        std::cerr << "Error: Cannot open " << inputFile << "\n";
+        return false;
+    }
+    OnePass run(data, listing, stats);
+    run.begin();
+    string_view line;
+    asmscan::LineBits bits;
+    while (in.next(line, bits)) run.statement(line, bits, (int)in.lineNumber());
+    run.finish();
+    return true;
+}
@@ -1,58 +1,37 @@
 #include "assembler.hpp"
-#include <fstream>
-#include <sstream>
+#include "inccache.hpp"
+#include "../../common/asm_lexer.hpp"
+#include "../../common/line_reader.hpp"
+#include "../../common/simd_scan.hpp"
+#include "../../common/thread_pool.hpp"
 #include <algorithm>
-#include <cctype>
+#include <charconv>
+#include <chrono>
+#include <cstring>
+#include <fstream>
 #include <iostream>
 
 using std::string;
-using std::vector;
+using std::string_view;
 
 // ============================================================================
 // UTILITY FUNCTIONS
 // ============================================================================
 
 /**
- * Trims whitespace characters from both ends of a string
- * @param s The input string to trim
- * @return A new string with leading and trailing whitespace removed
+ * Parses a decimal integer the way std::stoi does (leading whitespace,
+ * optional sign, trailing text ignored) but without exceptions or locales
+ * @param s The text to parse
+ * @param out Receives the value on success
+ * @return false if there are no digits or the value does not fit `out`
  */
-static string trim(const string& s) {
-    // Find the first character that is not whitespace
-    size_t a = s.find_first_not_of(" \t\r\n");
-    if (a == string::npos) return ""; // String is all whitespace
-    
-    // Find the last character that is not whitespace
-    size_t b = s.find_last_not_of(" \t\r\n");
-    
-    // Extract the substring between first and last non-whitespace characters
-    return s.substr(a, b - a + 1);
-}
-
-/**
- * Splits a string by a delimiter and returns vector of trimmed tokens
- * @param str The input string to split
- * @param delimiter The character to split on (e.g., comma)
- * @return Vector of trimmed, non-empty tokens
- */
-static vector<string> split(const string& str, char delimiter) {
-    vector<string> tokens;
-    string token;
-    size_t start = 0, end = 0;
-    
-    // Find each occurrence of the delimiter
-    while ((end = str.find(delimiter, start)) != string::npos) {
-        // Extract substring between delimiters
-        token = trim(str.substr(start, end - start));
-        if (!token.empty()) tokens.push_back(token); // Only add non-empty tokens
-        start = end + 1; // Move past the delimiter
-    }
-    
-    // Add the last token after the final delimiter
-    token = trim(str.substr(start));
-    if (!token.empty()) tokens.push_back(token);
-    
-    return tokens;
+template <typename Int>
+static bool parseInt(string_view s, Int& out) {
+    size_t i = 0;
+    while (i < s.size() && asmlex::isSpace(s[i])) ++i;
+    if (i < s.size() && s[i] == '+') ++i; // from_chars accepts '-' but not '+'
+    auto r = std::from_chars(s.data() + i, s.data() + s.size(), out);
+    return r.ec == std::errc();
 }
 
 // ============================================================================
@@ -64,63 +43,78 @@ static vector<string> split(const string& str, char delimiter) {
  * @param operand The operand string to check
  * @return true if the operand is a literal, false otherwise
  */
-static bool isLiteral(const string& operand) {
+static bool isLiteral(string_view operand) {
     return !operand.empty() && operand[0] == '=';
 }
 
+/**
+ * Converts a constant operand to an integer (0 if it is not numeric)
+ * @param v The operand text with any quotes already removed
+ * @return The integer value
+ */
+static int parseConstant(string_view v) {
+    int x = 0;
+    return parseInt(v, x) ? x : 0;
+}
+
 /**
  * Extracts the numeric value from a literal
  * Handles both plain numbers (=5) and character literals (='C')
  * @param literal The literal string including the '=' prefix
  * @return The integer value of the literal
  */
-static int getLiteralValue(const string& literal) {
+static int getLiteralValue(string_view literal) {
     // Remove the '=' prefix
-    string v = literal.substr(1);
+    string_view v = literal.substr(1);
     
     // Handle character literals enclosed in single quotes
-    if (!v.empty() && v.front() == '\'' && v.back() == '\'') {
+    if (v.size() >= 2 && v.front() == '\'' && v.back() == '\'') {
         v = v.substr(1, v.size() - 2); // Remove quotes
     }
     
     // Convert to integer, return 0 if conversion fails
-    try {
-        return std::stoi(v);
-    } catch (...) {
-        return 0;
-    }
+    return parseConstant(v);
 }
 
 /**
- * Adds a literal to the literal table if it doesn't already exist
+ * Adds a literal to the current literal pool if it isn't already in it
+ * Lookup is a single hash probe: literals of the current pool are interned to
+ * pool-local ordinals, so the table index is poolStart + ordinal
  * @param lit The literal string to add
  * @param d Reference to the assembler data structure
+ * @return The literal's index in the literal table
  */
-static void addLiteral(const string& lit, AssemblerData& d) {
-    // Check if literal already exists in the table
-    for (auto& L : d.literalTable) {
-        if (L.literal == lit) return; // Already exists, don't add duplicate
-    }
+static int addLiteral(string_view lit, AssemblerData& d) {
+    if (d.poolTable.empty()) d.poolTable.push_back(0); // First pool starts at index 0
     
-    // Add new literal entry (address will be assigned later)
-    d.literalTable.push_back(LiteralTableEntry(lit, getLiteralValue(lit)));
+    int idx = d.poolTable.back() + (int)d.poolLiterals.intern(lit);
+    if (idx == (int)d.literalTable.size()) {
+        // New in this pool - add entry (address will be assigned at LTORG/END)
+        d.literalTable.push_back(LiteralTableEntry(d.literalTexts.intern(lit), getLiteralValue(lit)));
+    }
+    return idx;
 }
 
 /**
- * Processes LTORG directive - assigns addresses to all pending literals
+ * Processes LTORG directive - assigns addresses to the literals of the current pool
  * This is called when LTORG is encountered or at END of program
  * @param d Reference to the assembler data structure
+ * @param openNextPool Start a new pool afterwards (LTORG) or not (END)
  */
-static void processLTORG(AssemblerData& d) {
-    // Iterate through all literals in the table
-    for (auto& L : d.literalTable) {
-        // Only process literals that haven't been assigned an address yet
-        if (L.address == -1) {
-            // Assign current location counter as the literal's address
-            L.address = d.locationCounter;
-            // Increment location counter (each literal takes 1 word)
-            d.locationCounter++;
-        }
+static void processLTORG(AssemblerData& d, bool openNextPool) {
+    if (d.poolTable.empty()) d.poolTable.push_back(0);
+    
+    // Only the current pool can hold literals without an address
+    for (size_t i = d.poolTable.back(); i < d.literalTable.size(); ++i) {
+        // Assign current location counter as the literal's address
+        d.literalTable[i].address = (Address)d.locationCounter;
+        // Increment location counter (each literal takes 1 word)
+        d.locationCounter++;
+    }
+    
+    if (openNextPool) {
+        d.poolTable.push_back((int)d.literalTable.size());
+        d.poolLiterals.clear();
     }
 }
 
@@ -128,77 +122,228 @@ static void processLTORG(AssemblerData& d) {
 // SYMBOL TABLE FUNCTIONS
 // ============================================================================
 
+/**
+ * Gives an already-interned symbol its address (label definition)
+ * A forward reference (referenced, not yet defined) takes `addr`; a symbol
+ * that is defined, or whose EQU is waiting to be resolved, is defined twice
+ * @param id The symbol's ID
+ * @param addr The address to assign to the symbol
+ * @param d Reference to the assembler data structure
+ * @param absolute The value does not move with the load address (EQU)
+ */
+static void defineSymbol(int id, Address addr, AssemblerData& d, bool absolute = false) {
+    SymbolTableEntry& e = d.symbolTable[id];
+    if (e.defined || e.equ >= 0) {
+        // Symbol already defined - this is an error (duplicate label)
+        d.errors.emplace_back("Error: Symbol '" + string(d.symbolIds.name(id)) + "' already defined");
+    } else {
+        // New symbol or forward reference - now we can set its actual address
+        e.address = addr;
+        e.defined = true;
+        e.absolute = absolute;
+    }
+}
+
+/**
+ * Records a definition or use of a symbol for the cross-reference index
+ * Does nothing unless d.crossReference is set (see xref.hpp)
+ * @param id The symbol's ID
+ * @param lineNum The line it appears on
+ * @param ic Index of the line's IC record
+ * @param kind How the line uses it
+ * @param d Reference to the assembler data structure
+ */
+static void addReference(int id, int lineNum, size_t ic, ReferenceKind kind, AssemblerData& d) {
+    if (d.crossReference) d.references.push_back({(std::uint32_t)id, (std::uint32_t)ic, (std::int32_t)lineNum, kind});
+}
+
 /**
  * Adds or updates a symbol in the symbol table
  * @param sym The symbol name to add
  * @param addr The address to assign to the symbol
+ * @param lineNum The line defining it (for the cross-reference index)
  * @param d Reference to the assembler data structure
+ * @param absolute The value does not move with the load address (EQU)
  */
-static void addSymbol(const string& sym, int addr, AssemblerData& d) {
-    // Check if symbol already exists in the table
-    auto it = d.symbolTable.find(sym);
-    
-    if (it != d.symbolTable.end()) {
-        // Symbol exists - check if it was forward referenced (address = 0)
-        if (it->second.address != 0) {
-            // Symbol already defined - this is an error (duplicate label)
-            d.errors.push_back("Error: Symbol '" + sym + "' already defined");
+static void addSymbol(string_view sym, Address addr, int lineNum, AssemblerData& d, bool absolute = false) {
+    // New symbols get the next dense ID, undefined, then are defined like forward references
+    const int id = addSymbolId(d, sym);
+    addReference(id, lineNum, d.intermediateCode.size(), ReferenceKind::DEFINITION, d);
+    defineSymbol(id, addr, d, absolute);
+}
+
+/**
+ * Returns the dense ID of a symbol
+ * If symbol doesn't exist, creates an undefined (forward reference) entry
+ * @param sym The symbol name to look up
+ * @param d Reference to the assembler data structure
+ * @return The symbol's ID (index into d.symbolTable)
+ */
+static int getSymbolId(string_view sym, AssemblerData& d) {
+    return addSymbolId(d, sym);
+}
+
+// ============================================================================
+// EXPRESSIONS (START / ORIGIN / EQU / DS operands)
+// ============================================================================
+//
+// Operands are compiled by common/expr.hpp. An EQU whose expression uses a
+// symbol that is not defined yet is deferred with its compiled code: it is
+// resolved when another expression first needs it, or at END, where all
+// deferred EQUs are resolved in dependency order and the ones left on
+// undefined symbols or cycles are reported. ORIGIN, START and DS move the
+// location counter, so their operands must be computable on their own line.
+
+/**
+ * Finishes a deferred EQU: defines its symbol or reports why it cannot
+ * @param index Index into d.deferredEqus
+ * @param r Its expression's result (an error no later line can fix, if not OK)
+ * @param d Reference to the assembler data structure
+ */
+static void settleEqu(int index, const asmexpr::Result& r, AssemblerData& d) {
+    const asmexpr::DeferredList::Entry& q = d.deferredEqus[index];
+    SymbolTableEntry& e = d.symbolTable[q.symbol];
+    e.equ = -1;
+    if (r.status == asmexpr::Status::OK) {
+        if (r.value < 0 || r.value >= ADDRESS_END) {
+            d.errors.emplace_back("Line " + std::to_string(q.line) + ": EQU value " +
+                               std::to_string(r.value) + " is outside the 32-bit address space");
         } else {
-            // Forward reference - now we can set its actual address
-            it->second.address = addr;
+            e.address = (Address)r.value;
+            e.defined = true;
+            e.absolute = asmexpr::isAbsolute(d.deferredEqus.code.data() + q.begin, q.end - q.begin, q.depth,
+                                             [&d](std::uint32_t id) { return d.symbolTable[id].absolute; });
         }
+        return;
+    }
+    const string where = "Line " + std::to_string(q.line) + ": EQU '" + string(d.symbolIds.name(q.symbol)) + "' ";
+    if (r.status == asmexpr::Status::UNDEFINED && d.symbolTable[r.symbol].equ >= 0) {
+        d.errors.emplace_back(where + "is circular through '" + string(d.symbolIds.name(r.symbol)) + "'");
     } else {
-        // New symbol - add it to the table
-        d.symbolTable[sym] = SymbolTableEntry(sym, addr, 1);
+        d.errors.emplace_back(where + asmexpr::describe(r, [&d](std::uint32_t id) { return d.symbolIds.name(id); }));
     }
 }
 
 /**
- * Retrieves the address of a symbol from the symbol table
- * If symbol doesn't exist, creates a forward reference entry with address 0
- * @param sym The symbol name to look up
+ * Resolves a deferred EQU after the deferred EQUs it depends on
+ * @param index Index into d.deferredEqus
+ * @param final At END: symbols still undefined stay undefined, so report them
  * @param d Reference to the assembler data structure
- * @return The address of the symbol (0 if forward reference)
  */
-static int getSymbolAddress(const string& sym, AssemblerData& d) {
-    auto it = d.symbolTable.find(sym);
-    
-    if (it != d.symbolTable.end()) {
-        // Symbol found - return its address
-        return it->second.address;
+static void resolveEqu(int index, bool final, AssemblerData& d) {
+    asmexpr::resolve(d.deferredEqus, index, final,
+        [&d](std::uint32_t id, std::int64_t& v) {
+            v = d.symbolTable[id].address;
+            return d.symbolTable[id].defined;
+        },
+        [&d](std::uint32_t id) { return (int)d.symbolTable[id].equ; },
+        [&d](int i, const asmexpr::Result& r) { settleEqu(i, r, d); });
+}
+
+/**
+ * Resolves every EQU still deferred, in dependency order (END)
+ * @param d Reference to the assembler data structure
+ */
+static void resolveDeferredEqus(AssemblerData& d) {
+    for (size_t i = 0; i < d.deferredEqus.size(); ++i) {
+        const asmexpr::DeferredList::Entry& q = d.deferredEqus[i];
+        if (d.symbolTable[q.symbol].equ == (std::int32_t)i) resolveEqu((int)i, true, d);
     }
-    
-    // Symbol not found - create forward reference with address 0
-    d.symbolTable[sym] = SymbolTableEntry(sym, 0, 1);
-    return 0;
+    d.deferredEqus.clear();
 }
 
 /**
- * Evaluates an expression (symbol, symbol+offset, or symbol-offset)
- * Used for ORIGIN and EQU directives
- * @param expr The expression string to evaluate
+ * Value of a symbol in an expression; a deferred EQU is resolved on first use
+ * @return false if the symbol has no value yet
+ */
+static bool symbolValue(std::uint32_t id, std::int64_t& v, AssemblerData& d) {
+    if (!d.symbolTable[id].defined && d.symbolTable[id].equ >= 0) resolveEqu(d.symbolTable[id].equ, false, d);
+    v = d.symbolTable[id].address;
+    return d.symbolTable[id].defined;
+}
+
+/**
+ * Compiles a directive operand (symbols are interned, forward references included)
+ * @param text The operand
+ * @param lineNum The line number (for the cross-reference index)
+ * @param e Receives the compiled expression
+ * @param why Receives the syntax error, if any
+ * @param d Reference to the assembler data structure
+ * @return false if the operand is not an expression
+ */
+static bool compileOperand(string_view text, int lineNum, asmexpr::Expr& e, string& why, AssemblerData& d) {
+    return asmexpr::compile(text, [&d, lineNum](string_view name) {
+        const int id = getSymbolId(name, d);
+        addReference(id, lineNum, d.intermediateCode.size(), ReferenceKind::EXPRESSION, d);
+        return (std::uint32_t)id;
+    }, e, why);
+}
+
+/**
+ * Evaluates a directive operand that is needed on its own line
+ * @param text The operand (a plain integer skips the compiler)
+ * @param lineNum The line number (for the cross-reference index)
+ * @param value Receives the value
+ * @param why Receives the reason on failure
+ * @param d Reference to the assembler data structure
+ * @return false if the operand has no value here
+ */
+static bool evaluateOperand(string_view text, int lineNum, std::int64_t& value, string& why, AssemblerData& d) {
+    if (asmexpr::parseInteger(text, value)) return true;
+    asmexpr::Expr& e = d.expression;
+    if (!compileOperand(text, lineNum, e, why, d)) return false;
+    const asmexpr::Result r = asmexpr::evaluate(e, [&d](std::uint32_t id, std::int64_t& v) { return symbolValue(id, v, d); });
+    if (r.status == asmexpr::Status::OK) { value = r.value; return true; }
+    why = asmexpr::describe(r, [&d](std::uint32_t id) { return d.symbolIds.name(id); });
+    return false;
+}
+
+/**
+ * Defines an EQU's label from its expression, or defers it while the
+ * expression uses symbols that are not defined yet
+ * @param label The EQU's label
+ * @param text Its operand
+ * @param lineNum The line number (for error reporting)
  * @param d Reference to the assembler data structure
- * @return The calculated address value
  */
-static int evaluateExpression(const string& expr, AssemblerData& d) {
-    // Check for addition operation (e.g., "LOOP+5")
-    size_t p = expr.find('+');
-    if (p != string::npos) {
-        // Split into symbol and offset, then add them
-        return getSymbolAddress(trim(expr.substr(0, p)), d) + 
-               std::stoi(trim(expr.substr(p + 1)));
+static void processEqu(string_view label, string_view text, int lineNum, AssemblerData& d) {
+    asmexpr::Expr& e = d.expression;
+    string why;
+    std::int64_t value = 0;
+    bool absolute = true;   // a plain integer
+    if (!asmexpr::parseInteger(text, value)) {
+        if (!compileOperand(text, lineNum, e, why, d)) {
+            d.errors.emplace_back("Line " + std::to_string(lineNum) + ": Invalid EQU expression '" +
+                               string(text) + "' (" + why + ")");
+            return;
+        }
+        const asmexpr::Result r = asmexpr::evaluate(e, [&d](std::uint32_t id, std::int64_t& v) { return symbolValue(id, v, d); });
+        if (r.status == asmexpr::Status::UNDEFINED) {
+            // Forward reference: keep the compiled expression until the symbol is defined
+            const int id = getSymbolId(label, d);
+            addReference(id, lineNum, d.intermediateCode.size(), ReferenceKind::DEFINITION, d);
+            SymbolTableEntry& s = d.symbolTable[id];
+            if (s.defined || s.equ >= 0) {
+                d.errors.emplace_back("Error: Symbol '" + string(label) + "' already defined");
+                return;
+            }
+            s.equ = (std::int32_t)d.deferredEqus.add((std::uint32_t)id, lineNum, e);
+            return;
+        }
+        if (r.status != asmexpr::Status::OK) {
+            d.errors.emplace_back("Line " + std::to_string(lineNum) + ": Invalid EQU expression '" + string(text) +
+                               "' (" + asmexpr::describe(r, [&d](std::uint32_t id) { return d.symbolIds.name(id); }) + ")");
+            return;
+        }
+        value = r.value;
+        absolute = asmexpr::isAbsolute(e, [&d](std::uint32_t id) { return d.symbolTable[id].absolute; });
     }
-    
-    // Check for subtraction operation (e.g., "LOOP-3")
-    size_t m = expr.find('-');
-    if (m != string::npos) {
-        // Split into symbol and offset, then subtract
-        return getSymbolAddress(trim(expr.substr(0, m)), d) - 
-               std::stoi(trim(expr.substr(m + 1)));
+    if (value < 0 || value >= ADDRESS_END) {
+        d.errors.emplace_back("Line " + std::to_string(lineNum) + ": EQU value " +
+                           std::to_string(value) + " is outside the 32-bit address space");
+    } else {
+        addSymbol(label, (Address)value, lineNum, d, absolute);
     }
-    
-    // No operation - just a simple symbol
-    return getSymbolAddress(expr, d);
 }
 
 // ============================================================================
@@ -206,133 +351,189 @@ static int evaluateExpression(const string& expr, AssemblerData& d) {
 // ============================================================================
 
 /**
- * Processes a single line of assembly source code
- * Handles labels, mnemonics, operands, and generates intermediate code
- * @param line The source code line to process
- * @param lineNum The line number (for error reporting)
- * @param data Reference to the assembler data structure
+ * Splits a source line into label, mnemonic and operands without copying
+ * Every field is a view into `line`; the MOT is only read
+ * @param line The source code line
+ * @param data Assembler data (for the MOT)
+ * @return The lexed line (mnemonic is empty for blank/comment lines)
  */
-static void processLine(const string& line, int lineNum, AssemblerData& data) {
+SourceLine lexSourceLine(string_view line, const AssemblerData& data) {
+    SourceLine sl;
+
     // ========== STEP 1: Clean the line ==========
-    string clean = line;
-    
-    // Remove comments (anything after semicolon)
-    size_t cpos = clean.find(';');
-    if (cpos != string::npos) {
-        clean = clean.substr(0, cpos);
-    }
-    
-    // Trim whitespace and skip empty lines
-    clean = trim(clean);
-    if (clean.empty()) return;
-
-    // ========== STEP 2: Tokenize the line ==========
-    std::istringstream iss(clean);
-    vector<string> toks;
-    string tok;
-    
-    // Split line into whitespace-separated tokens
-    while (iss >> tok) {
-        toks.push_back(tok);
-    }
-    
-    if (toks.empty()) return;
+    // Remove comments (anything after semicolon), trim, skip empty lines
+    string_view rest = asmlex::trim(asmlex::stripComment(line, ';'));
+    if (rest.empty()) return sl;
 
-    // ========== STEP 3: Parse label, mnemonic, and operands ==========
-    string label, mnemonic, operand1, operand2;
-    size_t idx = 0;
+    // ========== STEP 2: Label and mnemonic ==========
+    string_view first = asmlex::nextToken(rest, false);
+    const Instruction* ins = data.tables->MOT.findFolded(first);
+    ASM_STAT(data, motLookups);
 
-    // Check if first token is a label (not a mnemonic)
-    string first = toks[0];
-    std::transform(first.begin(), first.end(), first.begin(), ::toupper);
-    
     // If first token is not in MOT and there are more tokens, it's a label
-    if (data.MOT.find(first) == data.MOT.end() && toks.size() > 1) {
-        label = toks[idx++];
+    string_view peek = rest, second;
+    if (!ins && !(second = asmlex::nextToken(peek, false)).empty()) {
+        sl.label = first;
+        sl.mnemonic = second;
+        rest = peek;
+        ins = data.tables->MOT.findFolded(sl.mnemonic);
+        ASM_STAT(data, motLookups);
+    } else {
+        sl.mnemonic = first;
     }
+    sl.ins = ins;
+
+    // ========== STEP 3: Operands (comma-separated) ==========
+    string_view ops[2];
+    int n = asmlex::splitOperands(asmlex::trim(rest), ops, 2);
+    if (n > 0) sl.operand1 = ops[0];
+    if (n > 1) sl.operand2 = ops[1];
+    return sl;
+}
+
+/**
+ * lexSourceLine driven by the line's class bits (LineReader/LineScanner)
+ * Same result; the comment, the blank runs around the label and mnemonic and
+ * the commas between operands are found with bit scans instead of byte loops
+ * @param bits The line's bits; a line without valid bits takes the byte path
+ */
+SourceLine lexSourceLine(string_view line, const asmscan::LineBits& bits, const AssemblerData& data) {
+    if (!bits.valid) return lexSourceLine(line, data);
+    SourceLine sl;
+
+    // Code part of the line (before any ';') and its non-blank bytes
+    const size_t end = bits.comment ? (size_t)__builtin_ctzll(bits.comment) : line.size();
+    const std::uint64_t code = asmscan::lowBits(end);
+    std::uint64_t solid = ~bits.space & code;
+    if (!solid) return sl;
+
+    // Pops the next blank-delimited token off `solid`
+    size_t after = 0;
+    auto token = [&]() {
+        const size_t i = (size_t)__builtin_ctzll(solid);
+        const std::uint64_t gap = ~(solid >> i);
+        after = gap ? i + (size_t)__builtin_ctzll(gap) : 64;
+        solid &= ~asmscan::lowBits(after);
+        return line.substr(i, after - i);
+    };
 
-    // Get the mnemonic (instruction or directive)
-    if (idx < toks.size()) {
-        mnemonic = toks[idx++];
-        std::transform(mnemonic.begin(), mnemonic.end(), mnemonic.begin(), ::toupper);
+    const string_view first = token();
+    const Instruction* ins = data.tables->MOT.findFolded(first);
+    ASM_STAT(data, motLookups);
+    if (!ins && solid) {
+        sl.label = first;
+        sl.mnemonic = token();
+        ins = data.tables->MOT.findFolded(sl.mnemonic);
+        ASM_STAT(data, motLookups);
+    } else {
+        sl.mnemonic = first;
     }
+    sl.ins = ins;
 
-    // Parse operands (comma-separated)
-    if (idx < toks.size()) {
-        // Combine remaining tokens back into a single string
-        string rest;
-        for (size_t i = idx; i < toks.size(); ++i) {
-            rest += toks[i];
-            if (i + 1 < toks.size()) rest += " ";
+    // Operands: the rest of the code, cut at commas, each piece trimmed
+    std::uint64_t commas = bits.comma & code & ~asmscan::lowBits(after);
+    string_view* out[2] = {&sl.operand1, &sl.operand2};
+    int n = 0;
+    while (n < 2 && solid) {
+        const size_t to = commas ? (size_t)__builtin_ctzll(commas) : end;
+        const std::uint64_t piece = solid & asmscan::lowBits(to);
+        if (piece) {
+            const size_t a = (size_t)__builtin_ctzll(piece), b = 64 - (size_t)__builtin_clzll(piece);
+            *out[n++] = line.substr(a, b - a);
         }
-        
-        // Split operands by comma
-        auto ops = split(rest, ',');
-        if (!ops.empty()) operand1 = ops[0];
-        if (ops.size() > 1) operand2 = ops[1];
+        solid &= ~asmscan::lowBits(to + 1);
+        commas &= commas - 1;
     }
+    return sl;
+}
+
+/**
+ * Keeps the location counter inside the 32-bit address space
+ * A statement that moves it below 0 or past ADDRESS_END is reported and the
+ * LC is clamped, so one bad ORIGIN/DS yields one error, not a wrapped program
+ * @param lineNum The line that moved the LC
+ * @param d Reference to the assembler data structure
+ */
+static void checkLocationCounter(int lineNum, AssemblerData& d) {
+    if (d.locationCounter >= 0 && d.locationCounter <= ADDRESS_END) return;
+    d.errors.emplace_back("Line " + std::to_string(lineNum) + ": Location counter " +
+                       std::to_string(d.locationCounter) + " is outside the 32-bit address space");
+    d.locationCounter = d.locationCounter < 0 ? 0 : ADDRESS_END;
+}
+
+/**
+ * Assembles a single lexed statement (see processSourceLine)
+ * @param sl The lexed source line (mnemonic must not be empty)
+ * @param lineNum The line number (for error reporting)
+ * @param data Reference to the assembler data structure
+ */
+static void assembleStatement(const SourceLine& sl, int lineNum, AssemblerData& data) {
+    const string_view label = sl.label, operand1 = sl.operand1, operand2 = sl.operand2;
 
     // ========== STEP 4: Create intermediate code entry ==========
     IntermediateCodeLine ic;
     ic.lineNumber = lineNum;
-    ic.locationCounter = data.locationCounter;
+    ic.locationCounter = (Address)data.locationCounter;
 
     // ========== STEP 5: Process assembler directives ==========
-    
-    // START directive - sets the starting address of the program
-    if (mnemonic == "START") {
-        if (!operand1.empty()) {
-            data.startingAddress = std::stoi(operand1);
-            data.locationCounter = data.startingAddress;
-            ic.locationCounter = data.locationCounter;
-        }
-        ic.type = "AD"; // Assembler Directive
-        ic.opcode = "1"; // START opcode
-        ic.operand1Type = "C"; // Constant
-        ic.operand1Value = std::to_string(data.startingAddress);
-        data.intermediateCode.push_back(ic);
-        return;
-    }
-    
-    // END directive - marks end of program and processes pending literals
-    if (mnemonic == "END") {
-        processLTORG(data); // Assign addresses to all pending literals
-        ic.type = "AD";
-        ic.opcode = "2"; // END opcode
-        data.intermediateCode.push_back(ic);
-        return;
-    }
-    
-    // ORIGIN directive - changes the location counter
-    if (mnemonic == "ORIGIN") {
-        if (!operand1.empty()) {
-            data.locationCounter = evaluateExpression(operand1, data);
-            ic.locationCounter = data.locationCounter;
-        }
-        ic.type = "AD";
-        ic.opcode = "3"; // ORIGIN opcode
-        ic.operand1Value = operand1;
-        data.intermediateCode.push_back(ic);
-        return;
-    }
-    
-    // EQU directive - assigns a value to a symbol without allocating memory
-    if (mnemonic == "EQU") {
-        if (!label.empty() && !operand1.empty()) {
-            addSymbol(label, evaluateExpression(operand1, data), data);
+    const Instruction* ins = sl.ins;
+    if (ins && ins->type == InstructionType::ASSEMBLER) {
+        ic.type = ICType::AD; // Assembler Directive
+        ic.opcode = (std::uint8_t)ins->opcode;
+
+        switch (ins->opcode) {
+        // START directive - sets the starting address of the program
+        case 1:
+            if (!operand1.empty()) {
+                std::int64_t start = 0;
+                string why;
+                if (!evaluateOperand(operand1, lineNum, start, why, data)) {
+                    data.errors.emplace_back("Line " + std::to_string(lineNum) +
+                                          ": Invalid start address '" + string(operand1) + "' (" + why + ")");
+                } else if (start < 0 || start >= ADDRESS_END) {
+                    data.errors.emplace_back("Line " + std::to_string(lineNum) +
+                                          ": Invalid start address '" + string(operand1) + "'");
+                } else {
+                    data.startingAddress = (Address)start;
+                }
+                data.locationCounter = data.startingAddress;
+                ic.locationCounter = data.startingAddress;
+            }
+            ic.operand1Type = OperandKind::C; // Constant
+            ic.operand1Value = (std::int32_t)data.startingAddress;
+            break;
+
+        // END directive - marks end of program and processes pending literals
+        case 2:
+            processLTORG(data, false); // Assign addresses to the last pool's literals
+            resolveDeferredEqus(data); // EQUs that waited on forward references
+            break;
+
+        // ORIGIN directive - changes the location counter (expression folded into LC)
+        case 3:
+            if (!operand1.empty()) {
+                std::int64_t origin = 0;
+                string why;
+                if (evaluateOperand(operand1, lineNum, origin, why, data)) {
+                    data.locationCounter = origin;
+                    ic.locationCounter = (Address)data.locationCounter;
+                } else {
+                    data.errors.emplace_back("Line " + std::to_string(lineNum) + ": Invalid ORIGIN expression '" +
+                                          string(operand1) + "' (" + why + ")");
+                }
+            }
+            break;
+
+        // EQU directive - assigns a value to a symbol without allocating memory
+        case 4:
+            if (!label.empty() && !operand1.empty()) processEqu(label, operand1, lineNum, data);
+            break;
+
+        // LTORG directive - forces literal pool generation
+        case 5:
+            processLTORG(data, true);
+            break;
         }
-        ic.type = "AD";
-        ic.opcode = "4"; // EQU opcode
-        ic.operand1Value = operand1;
-        data.intermediateCode.push_back(ic);
-        return;
-    }
-    
-    // LTORG directive - forces literal pool generation
-    if (mnemonic == "LTORG") {
-        processLTORG(data);
-        ic.type = "AD";
-        ic.opcode = "5"; // LTORG opcode
         data.intermediateCode.push_back(ic);
         return;
     }
@@ -340,39 +541,35 @@ static void processLine(const string& line, int lineNum, AssemblerData& data) {
     // ========== STEP 6: Process label if present ==========
     // If this line has a label, add it to symbol table with current LC
     if (!label.empty()) {
-        addSymbol(label, data.locationCounter, data);
+        addSymbol(label, (Address)data.locationCounter, lineNum, data);
     }
 
-    // ========== STEP 7: Look up instruction in MOT ==========
-    auto it = data.MOT.find(mnemonic);
-    if (it == data.MOT.end()) {
+    // ========== STEP 7: Check the MOT lookup ==========
+    if (!ins) {
         // Unknown instruction - add error and skip
-        data.errors.push_back("Line " + std::to_string(lineNum) + 
+        string mnemonic(sl.mnemonic);
+        for (char& c : mnemonic) c = asmlex::toUpper(c);
+        data.errors.emplace_back("Line " + std::to_string(lineNum) + 
                              ": Unknown instruction '" + mnemonic + "'");
         return;
     }
 
-    Instruction ins = it->second;
-
     // ========== STEP 8: Process imperative statements (machine instructions) ==========
-    if (ins.type == InstructionType::IMPERATIVE) {
-        ic.type = "IS"; // Imperative Statement
-        ic.opcode = std::to_string(ins.opcode);
+    if (ins->type == InstructionType::IMPERATIVE) {
+        ic.type = ICType::IS; // Imperative Statement
+        ic.opcode = (std::uint8_t)ins->opcode;
 
         // Process first operand (usually a register or condition code)
         if (!operand1.empty()) {
-            string op1 = operand1;
-            std::transform(op1.begin(), op1.end(), op1.begin(), ::toupper);
-            
             // Check if operand is a register (e.g., AREG, BREG)
-            if (data.REGISTERS.count(op1)) {
-                ic.operand1Type = "R"; // Register
-                ic.operand1Value = std::to_string(data.REGISTERS[op1]);
+            if (const int* r = data.tables->REGISTERS.findFolded(operand1)) {
+                ic.operand1Type = OperandKind::R; // Register
+                ic.operand1Value = *r;
             }
             // Check if operand is a condition code (e.g., LT, EQ, GT)
-            else if (data.CONDITION_CODES.count(op1)) {
-                ic.operand1Type = "CC"; // Condition Code
-                ic.operand1Value = std::to_string(data.CONDITION_CODES[op1]);
+            else if (const int* cc = data.tables->CONDITION_CODES.findFolded(operand1)) {
+                ic.operand1Type = OperandKind::CC; // Condition Code
+                ic.operand1Value = *cc;
             }
         }
 
@@ -380,21 +577,14 @@ static void processLine(const string& line, int lineNum, AssemblerData& data) {
         if (!operand2.empty()) {
             // Check if operand is a literal (starts with '=')
             if (isLiteral(operand2)) {
-                addLiteral(operand2, data); // Add to literal table
-                ic.operand2Type = "L"; // Literal
-                
-                // Find the literal's index in the table
-                for (size_t i = 0; i < data.literalTable.size(); ++i) {
-                    if (data.literalTable[i].literal == operand2) {
-                        ic.operand2Value = std::to_string((int)i);
-                        break;
-                    }
-                }
+                ic.operand2Type = OperandKind::L; // Literal
+                ic.operand2Value = addLiteral(operand2, data); // Index in the literal table
             } else {
-                // Operand is a symbol (memory address)
-                getSymbolAddress(operand2, data); // Add to symbol table if needed
-                ic.operand2Type = "S"; // Symbol
-                ic.operand2Value = operand2;
+                // Operand is a symbol (memory address), carried by ID
+                ic.operand2Type = OperandKind::S; // Symbol
+                ic.operand2Value = getSymbolId(operand2, data);
+                addReference(ic.operand2Value, lineNum, data.intermediateCode.size(), ReferenceKind::OPERAND, data);
+                if (!data.symbolTable[ic.operand2Value].defined) ASM_STAT(data, forwardRefs);
             }
         }
         
@@ -402,117 +592,774 @@ static void processLine(const string& line, int lineNum, AssemblerData& data) {
         data.intermediateCode.push_back(ic);
         
         // Increment location counter by instruction length
-        data.locationCounter += ins.length;
+        data.locationCounter += ins->length;
     }
     // ========== STEP 9: Process declarative statements (data declarations) ==========
-    else if (ins.type == InstructionType::DECLARATIVE) {
-        ic.type = "DL"; // Declarative Statement
-        ic.opcode = std::to_string(ins.opcode);
+    else if (ins->type == InstructionType::DECLARATIVE) {
+        ic.type = ICType::DL; // Declarative Statement
+        ic.opcode = (std::uint8_t)ins->opcode;
         
         // DS (Define Storage) - reserves memory space
-        if (mnemonic == "DS") {
-            int size = operand1.empty() ? 1 : std::stoi(operand1);
-            ic.operand1Type = "C"; // Constant
-            ic.operand1Value = std::to_string(size);
+        if (ins->opcode == 1) {
+            std::int64_t size = 1;
+            string why;
+            if (!operand1.empty() && !evaluateOperand(operand1, lineNum, size, why, data)) {
+                data.errors.emplace_back("Line " + std::to_string(lineNum) +
+                                      ": Invalid DS size '" + string(operand1) + "' (" + why + ")");
+                size = 0;
+            } else if (size < INT32_MIN || size > INT32_MAX) {
+                data.errors.emplace_back("Line " + std::to_string(lineNum) +
+                                      ": Invalid DS size '" + string(operand1) + "'");
+                size = 0;
+            }
+            ic.operand1Type = OperandKind::C; // Constant
+            ic.operand1Value = (std::int32_t)size;
             data.intermediateCode.push_back(ic);
             data.locationCounter += size; // Reserve 'size' words
         }
         // DC (Define Constant) - defines an initialized data value
-        else if (mnemonic == "DC") {
-            string v = operand1;
+        else if (ins->opcode == 2) {
+            string_view v = operand1;
             
             // Remove quotes from string literals
-            if (!v.empty() && v.front() == '\'' && v.back() == '\'') {
+            if (v.size() >= 2 && v.front() == '\'' && v.back() == '\'') {
                 v = v.substr(1, v.size() - 2);
             }
             
-            ic.operand1Type = "C"; // Constant
-            ic.operand1Value = v;
+            ic.operand1Type = OperandKind::C; // Constant
+            ic.operand1Value = parseConstant(v);
             data.intermediateCode.push_back(ic);
             data.locationCounter += 1; // Takes 1 word of memory
         }
     }
 }
 
+/**
+ * Processes a single lexed line of assembly source code
+ * Handles labels, mnemonics, operands, and generates intermediate code
+ * @param sl The lexed source line (mnemonic must not be empty)
+ * @param lineNum The line number (for error reporting)
+ * @param data Reference to the assembler data structure
+ */
+static void processSourceLine(const SourceLine& sl, int lineNum, AssemblerData& data) {
+    assembleStatement(sl, lineNum, data);
+    checkLocationCounter(lineNum, data);
+}
+
+/**
+ * Lexes and processes a single line of assembly source code
+ * @param line The source code line to process
+ * @param bits Its class bits (see simd_scan.hpp)
+ * @param lineNum The line number (for error reporting)
+ * @param data Reference to the assembler data structure
+ */
+static void processLine(string_view line, const asmscan::LineBits& bits, int lineNum, AssemblerData& data) {
+    const SourceLine sl = lexSourceLine(line, bits, data);
+    if (!sl.mnemonic.empty()) processSourceLine(sl, lineNum, data);
+}
+
+// ============================================================================
+// SPECULATIVE PARALLEL PASS 1
+// ============================================================================
+//
+// The only thing that flows from line to line is the location counter, and
+// outside of assembler directives every line advances it by an amount known
+// from the line alone (instruction length, 1 for DC, the DS operand). So:
+//
+//   1. In parallel, every chunk of lines is lexed and, if it holds no
+//      directive, assembled as if it started at LC 0: symbols and literals
+//      are interned into chunk-local IDs and the chunk's LC delta is summed.
+//   2. In order, the chunks are merged: a running prefix sum of the deltas
+//      gives each chunk its starting LC, chunk-local symbols/literals are
+//      mapped onto global IDs, and labels receive their addresses. Chunks
+//      holding START/ORIGIN/EQU/LTORG/END (whose effect depends on the
+//      tables built so far) are replayed serially through processSourceLine.
+//   3. In parallel, the chunk IC records are relocated into the final table.
+//
+// A chunk whose LC would leave the address space at some line is replayed
+// serially too, so the range error names the same line as a serial run.
+//
+// Symbol IDs, literal indices, IC and errors come out exactly as from the
+// serial pass1().
+
+// A label definition inside a chunk, in line order
+struct ChunkLabel {
+    std::uint32_t symbol;   // chunk-local symbol ID
+    std::int64_t lcOffset;  // LC relative to the chunk start
+    int line;               // line within the chunk (1-based)
+    std::uint32_t code;     // IC records of the chunk before it
+};
+
+// A line-numbered error raised inside a chunk (text follows "Line N")
+struct ChunkError {
+    int line;
+    string text;
+};
+
+struct Pass1Chunk {
+    size_t begin = 0, end = 0;      // byte range in the mapped source
+    int lineBase = 0;               // global number of the line before the chunk
+    int lineCount = 0;
+    bool serial = false;            // holds a directive: replayed in order
+
+    std::vector<std::pair<int, SourceLine>> lines;  // lexed lines (serial chunks only)
+
+    // Speculative result, relative to the chunk start (non-serial chunks)
+    std::int64_t lcDelta = 0;
+    std::int64_t lcLow = 0, lcHigh = 0;  // LC range reached after any line
+    std::int64_t lcStart = 0;
+    SymbolInterner symbols;         // names in first-seen order
+    SymbolInterner literals;        // literal text in first-seen order
+    std::vector<ChunkLabel> labels;
+    std::vector<ChunkError> errors;
+    std::vector<IntermediateCodeLine> code;
+    std::vector<int> symbolMap, literalMap; // chunk-local -> global, filled by the merge
+};
+
+/**
+ * Size of a DS whose operand is a plain integer (or absent)
+ * @return false if the operand is an expression or out of range; such a DS
+ *         depends on the symbols defined so far and is processed in order
+ */
+static bool plainDsSize(const SourceLine& sl, std::int64_t& size) {
+    size = 1;
+    if (sl.operand1.empty()) return true;
+    return asmexpr::parseInteger(sl.operand1, size) && size >= INT32_MIN && size <= INT32_MAX;
+}
+
+/**
+ * Lexes the lines of one chunk into c.lines; marks the chunk serial if a
+ * directive, or a DS sized by an expression, is among them
+ */
+static void lexChunk(const char* text, Pass1Chunk& c, const AssemblerData& data) {
+    asmscan::LineScanner scan;
+    scan.reset(text + c.begin, c.end - c.begin);
+    string_view line;
+    asmscan::LineBits bits;
+    int local = 0;
+    while (scan.next(line, bits)) {
+        ++local;
+        SourceLine sl = lexSourceLine(line, bits, data);
+        if (sl.mnemonic.empty()) continue;
+        std::int64_t size;
+        if (sl.ins && (sl.ins->type == InstructionType::ASSEMBLER ||
+                       (sl.ins->type == InstructionType::DECLARATIVE && sl.ins->opcode == 1 && !plainDsSize(sl, size))))
+            c.serial = true;
+        c.lines.push_back({local, sl});
+    }
+    c.lineCount = local;
+}
+
+/**
+ * Lexes one chunk and, unless it holds a directive, assembles it relative
+ * to LC 0 (mirrors processSourceLine for the non-directive cases)
+ * Only reads `data` (the MOT and register tables), so chunks run concurrently
+ */
+static void assembleChunk(const char* text, Pass1Chunk& c, const AssemblerData& data) {
+    lexChunk(text, c, data);
+    if (c.serial) return;
+
+    std::int64_t lc = 0;
+    for (const auto& entry : c.lines) {
+        const int line = entry.first;
+        const SourceLine& sl = entry.second;
+        const Instruction* ins = sl.ins;
+
+        if (!sl.label.empty()) c.labels.push_back({c.symbols.intern(sl.label), lc, line, (std::uint32_t)c.code.size()});
+
+        if (!ins) {
+            string mnemonic(sl.mnemonic);
+            for (char& ch : mnemonic) ch = asmlex::toUpper(ch);
+            c.errors.push_back({line, ": Unknown instruction '" + mnemonic + "'"});
+            continue;
+        }
+
+        IntermediateCodeLine ic;
+        ic.lineNumber = line;
+        ic.locationCounter = (Address)lc;   // relative; wraps back when the chunk start is added
+        ic.opcode = (std::uint8_t)ins->opcode;
+
+        if (ins->type == InstructionType::IMPERATIVE) {
+            ic.type = ICType::IS;
+            if (!sl.operand1.empty()) {
+                if (const int* r = data.tables->REGISTERS.findFolded(sl.operand1)) {
+                    ic.operand1Type = OperandKind::R;
+                    ic.operand1Value = *r;
+                } else if (const int* cc = data.tables->CONDITION_CODES.findFolded(sl.operand1)) {
+                    ic.operand1Type = OperandKind::CC;
+                    ic.operand1Value = *cc;
+                }
+            }
+            if (!sl.operand2.empty()) {
+                if (isLiteral(sl.operand2)) {
+                    ic.operand2Type = OperandKind::L;
+                    ic.operand2Value = (std::int32_t)c.literals.intern(sl.operand2);
+                } else {
+                    ic.operand2Type = OperandKind::S;
+                    ic.operand2Value = (std::int32_t)c.symbols.intern(sl.operand2);
+                }
+            }
+            c.code.push_back(ic);
+            lc += ins->length;
+        } else if (ins->opcode == 1) { // DS (plain sizes only, see lexChunk)
+            std::int64_t size;
+            plainDsSize(sl, size);
+            ic.type = ICType::DL;
+            ic.operand1Type = OperandKind::C;
+            ic.operand1Value = (std::int32_t)size;
+            c.code.push_back(ic);
+            lc += size;
+        } else if (ins->opcode == 2) { // DC
+            string_view v = sl.operand1;
+            if (v.size() >= 2 && v.front() == '\'' && v.back() == '\'') v = v.substr(1, v.size() - 2);
+            ic.type = ICType::DL;
+            ic.operand1Type = OperandKind::C;
+            ic.operand1Value = parseConstant(v);
+            c.code.push_back(ic);
+            lc += 1;
+        }
+        c.lcLow = std::min(c.lcLow, lc);
+        c.lcHigh = std::max(c.lcHigh, lc);
+    }
+    c.lcDelta = lc;
+    c.lines.clear();
+    c.lines.shrink_to_fit();
+}
+
+/**
+ * Merges a speculatively assembled chunk into the global tables
+ * Symbols and literals are added in the chunk's first-seen order, so they
+ * get the same IDs as in a serial run; label definitions and errors are
+ * replayed in line order so duplicate-label errors interleave correctly
+ * @param icBase Index the chunk's first IC record will have (cross-reference index)
+ */
+static void mergeChunk(Pass1Chunk& c, size_t icBase, AssemblerData& data) {
+    c.lcStart = data.locationCounter;
+
+    c.symbolMap.resize(c.symbols.size());
+    for (std::uint32_t i = 0; i < c.symbols.size(); ++i)
+        c.symbolMap[i] = getSymbolId(c.symbols.name(i), data);
+    c.literalMap.resize(c.literals.size());
+    for (std::uint32_t i = 0; i < c.literals.size(); ++i)
+        c.literalMap[i] = addLiteral(c.literals.name(i), data);
+
+    // A label is handled before any error on its own line (as in processSourceLine)
+    size_t e = 0;
+    for (const ChunkLabel& l : c.labels) {
+        for (; e < c.errors.size() && c.errors[e].line < l.line; ++e)
+            data.errors.emplace_back("Line " + std::to_string(c.lineBase + c.errors[e].line) + c.errors[e].text);
+        addReference(c.symbolMap[l.symbol], c.lineBase + l.line, icBase + l.code, ReferenceKind::DEFINITION, data);
+        defineSymbol(c.symbolMap[l.symbol], (Address)(c.lcStart + l.lcOffset), data);
+    }
+    for (; e < c.errors.size(); ++e)
+        data.errors.emplace_back("Line " + std::to_string(c.lineBase + c.errors[e].line) + c.errors[e].text);
+    if (data.crossReference) {
+        for (size_t k = 0; k < c.code.size(); ++k)
+            if (c.code[k].operand2Type == OperandKind::S)
+                addReference(c.symbolMap[c.code[k].operand2Value], c.lineBase + c.code[k].lineNumber, icBase + k,
+                             ReferenceKind::OPERAND, data);
+    }
+
+    data.locationCounter += c.lcDelta;
+}
+
+/**
+ * Parallel Pass 1 over a memory-mapped source
+ * @return false if the file cannot be mapped (the caller falls back to serial)
+ */
+static bool pass1Parallel(const std::string& inputFile, AssemblerData& data, unsigned threads) {
+    MappedFile src;
+    if (inputFile == "-" || !src.open(inputFile)) return false;
+
+    // ========== Cut the source into line-aligned chunks ==========
+    const size_t kChunkBytes = 64 * 1024;
+    const char* text = src.data();
+    const size_t size = src.size();
+    std::vector<Pass1Chunk> chunks;
+    for (size_t pos = 0; pos < size;) {
+        size_t end = std::min(size, pos + kChunkBytes);
+        const void* nl = end < size ? std::memchr(text + end, '\n', size - end) : nullptr;
+        end = nl ? (size_t)(static_cast<const char*>(nl) - text) + 1 : size;
+        chunks.emplace_back();
+        chunks.back().begin = pos;
+        chunks.back().end = end;
+        pos = end;
+    }
+
+    // ========== Step 1: lex + speculative assembly, in parallel ==========
+    ThreadPool pool(threads);
+    pool.parallelFor(chunks.size(), [&](size_t i) { assembleChunk(text, chunks[i], data); });
+
+    // ========== Step 2: ordered merge (LC prefix sum, global IDs) ==========
+    const size_t codeBase = data.intermediateCode.size();
+    size_t icBase = codeBase;   // final index of the chunk's first IC record
+    int lineBase = 0;
+    for (Pass1Chunk& c : chunks) {
+        c.lineBase = lineBase;
+        lineBase += c.lineCount;
+        if (!c.serial && data.locationCounter + c.lcLow >= 0 && data.locationCounter + c.lcHigh <= ADDRESS_END) {
+            mergeChunk(c, icBase, data);
+            icBase += c.code.size();
+            continue;
+        }
+        if (!c.serial) {
+            // Leaves the address space somewhere inside: lex it again and replay it
+            c.code.clear();
+            c.lines.clear();
+            lexChunk(text, c, data);
+            c.serial = true;
+        }
+        // Directives depend on the tables so far: replay the chunk line by line,
+        // then move its IC into the chunk (the two vectors may use different resources)
+        const size_t mark = data.intermediateCode.size(), refMark = data.references.size();
+        for (const auto& entry : c.lines) processSourceLine(entry.second, c.lineBase + entry.first, data);
+        c.code.assign(data.intermediateCode.begin() + mark, data.intermediateCode.end());
+        data.intermediateCode.resize(mark);
+        for (size_t r = refMark; r < data.references.size(); ++r)
+            data.references[r].ic += (std::uint32_t)(icBase - mark);   // IC indices as in the final table
+        icBase += c.code.size();
+    }
+
+    // ========== Step 3: relocate chunk IC into the final table, in parallel ==========
+    std::vector<size_t> offset(chunks.size() + 1, codeBase);
+    for (size_t i = 0; i < chunks.size(); ++i) offset[i + 1] = offset[i] + chunks[i].code.size();
+    data.intermediateCode.resize(offset.back());
+    pool.parallelFor(chunks.size(), [&](size_t i) {
+        const Pass1Chunk& c = chunks[i];
+        IntermediateCodeLine* out = data.intermediateCode.data() + offset[i];
+        for (IntermediateCodeLine ic : c.code) {
+            if (!c.serial) {
+                ic.lineNumber += c.lineBase;
+                ic.locationCounter += (Address)c.lcStart;
+                if (ic.operand2Type == OperandKind::S) ic.operand2Value = c.symbolMap[ic.operand2Value];
+                else if (ic.operand2Type == OperandKind::L) ic.operand2Value = c.literalMap[ic.operand2Value];
+            }
+            *out++ = ic;
+        }
+    });
+    return true;
+}
+
 // ============================================================================
-// PASS 1 MAIN FUNCTION
+// INCREMENTAL PASS 1
 // ============================================================================
+//
+// Lines are matched against the previous run's cache by hash: the common
+// prefix and suffix directly, each line in between to the cached line with the
+// same hash nearest to where it would be (so any number of edits, insertions
+// or moves costs only the lines actually changed). A cache entry depends only
+// on its line's text, so any line with the same hash may be replayed. Matched
+// IS/DS/DC lines are replayed from their cached fields in source order, which
+// shifts their LCs and re-resolves their symbols and literals exactly as
+// lexing them would; changed lines, directives and erroneous lines go through
+// the lexer.
 
 /**
- * Performs Pass 1 of the two-pass assembler
+ * Lexes and processes one line, recording what the next cache needs about it
+ * @param entry Cache entry for the line (hash already set)
+ */
+static void decodeLine(string_view line, int lineNum, AssemblerData& data, CachedLine& entry) {
+    const SourceLine sl = lexSourceLine(line, data);
+    if (sl.mnemonic.empty()) { entry.kind = CachedLineKind::BLANK; return; }
+
+    const size_t icBefore = data.intermediateCode.size(), errorsBefore = data.errors.size();
+    const std::int64_t lcBefore = data.locationCounter;
+    processSourceLine(sl, lineNum, data);
+
+    // Only lines whose effect follows from their own text can be replayed
+    // (an error may come from the context, e.g. the LC leaving the address space;
+    // a DS sized by an expression depends on the symbols defined before it)
+    std::int64_t size;
+    if (!sl.ins || sl.ins->type == InstructionType::ASSEMBLER || data.errors.size() != errorsBefore ||
+        data.intermediateCode.size() == icBefore ||
+        (sl.ins->type == InstructionType::DECLARATIVE && sl.ins->opcode == 1 && !plainDsSize(sl, size))) {
+        entry.kind = CachedLineKind::RELEX;
+        return;
+    }
+    const IntermediateCodeLine& ic = data.intermediateCode.back();
+    entry.kind = CachedLineKind::CODE;
+    entry.type = ic.type;
+    entry.opcode = ic.opcode;
+    entry.operand1Type = ic.operand1Type;
+    entry.operand1Value = ic.operand1Value;
+    entry.operand2Type = ic.operand2Type;
+    entry.operand2Value = ic.operand2Value;
+    entry.label = sl.label.empty() ? -1 : (std::int32_t)data.symbolIds.find(sl.label);
+    entry.lcDelta = (std::int32_t)(data.locationCounter - lcBefore);
+}
+
+/**
+ * Pass 1 against the previous run's cache
+ * Fills `data` exactly as pass1() would, plus this run's cache entries
+ * @return false if the source cannot be mapped
+ */
+bool pass1Incremental(const std::string& inputFile, const IncrementalCache& old,
+                      AssemblerData& data, IncrementalRun& run) {
+    MappedFile src;
+    if (inputFile == "-" || !src.open(inputFile)) {
+        std::cerr << "Error: Cannot open " << inputFile << " (incremental mode needs a regular file)\n";
+        return false;
+    }
+
+    // ========== STEP 1: split and hash every line ==========
+    std::vector<string_view> lines;
+    for (string_view rest(src.data(), src.size()); !rest.empty();) {
+        size_t nl = rest.find('\n');
+        lines.push_back(rest.substr(0, nl));
+        rest.remove_prefix(nl == string_view::npos ? rest.size() : nl + 1);
+    }
+    const size_t n = lines.size(), nOld = old.lineCount();
+    run.lines.assign(n, CachedLine{});
+    for (size_t i = 0; i < n; ++i) run.lines[i].hash = hashLine(lines[i]);
+
+    // ========== STEP 2: match the unchanged prefix and suffix ==========
+    size_t prefix = 0, suffix = 0;
+    while (prefix < n && prefix < nOld && run.lines[prefix].hash == old.line(prefix).hash) ++prefix;
+    while (suffix < n - prefix && suffix < nOld - prefix &&
+           run.lines[n - 1 - suffix].hash == old.line(nOld - 1 - suffix).hash) ++suffix;
+    run.oldLine.assign(n, -1);
+    for (size_t i = 0; i < prefix; ++i) run.oldLine[i] = (std::int32_t)i;
+    for (size_t k = 1; k <= suffix; ++k) run.oldLine[n - k] = (std::int32_t)(nOld - k);
+
+    // Lines between them: each takes the old line of the same span with its hash
+    // nearest its expected position, which follows the offset of the last match
+    // so the LCs (and machine code) line up. The expected line itself is tried
+    // first; the (hash, line) index of the span is sorted on the first miss.
+    if (prefix + suffix < n && prefix + suffix < nOld) {
+        const std::int64_t oldEnd = (std::int64_t)(nOld - suffix);
+        std::vector<std::pair<std::uint64_t, std::uint32_t>> byHash;
+        std::int64_t shift = 0;   // old line - new line at the last match
+        for (size_t i = prefix; i < n - suffix; ++i) {
+            const std::uint64_t h = run.lines[i].hash;
+            const std::int64_t expected = (std::int64_t)i + shift;
+            if (expected >= (std::int64_t)prefix && expected < oldEnd && old.line((std::uint32_t)expected).hash == h) {
+                run.oldLine[i] = (std::int32_t)expected;
+                continue;
+            }
+            if (byHash.empty()) {
+                for (size_t o = prefix; o < nOld - suffix; ++o) byHash.push_back({old.line(o).hash, (std::uint32_t)o});
+                std::sort(byHash.begin(), byHash.end());
+            }
+            const auto first = std::lower_bound(byHash.begin(), byHash.end(), std::make_pair(h, std::uint32_t(0)));
+            if (first == byHash.end() || first->first != h) continue;
+            auto it = std::lower_bound(first, byHash.end(),
+                                       std::make_pair(h, (std::uint32_t)std::max<std::int64_t>(expected, 0)));
+            if (it == byHash.end() || it->first != h ||
+                (it != first && expected - (std::int64_t)std::prev(it)->second < (std::int64_t)it->second - expected))
+                it = std::prev(it);
+            run.oldLine[i] = (std::int32_t)it->second;
+            shift = (std::int64_t)it->second - (std::int64_t)i;
+        }
+    }
+
+    // ========== STEP 3: replay matched lines, lex the rest ==========
+    std::vector<int> symbolMap(old.symbolCount(), -1); // cached symbol ID -> ID in this run
+    auto symbol = [&](std::int32_t cachedId) {
+        int& id = symbolMap[cachedId];
+        if (id < 0) id = addSymbolId(data, old.symbolName(cachedId));
+        return id;
+    };
+
+    for (size_t i = 0; i < n; ++i) {
+        const int lineNum = (int)i + 1;
+        CachedLine& entry = run.lines[i];
+        const std::int32_t o = run.oldLine[i];
+
+        if (o >= 0 && old.line(o).kind == CachedLineKind::BLANK) {
+            entry.kind = CachedLineKind::BLANK;
+            continue;
+        }
+        if (o < 0 || old.line(o).kind != CachedLineKind::CODE) {
+            if (o < 0) ++run.changed;
+            ++run.reprocessed;
+            decodeLine(lines[i], lineNum, data, entry);
+            continue;
+        }
+
+        // Replay: same steps as processSourceLine, with names taken from the cache
+        const CachedLine& c = old.line(o);
+        entry = c;
+        if (c.label >= 0) {
+            entry.label = symbol(c.label);
+            addReference(entry.label, lineNum, data.intermediateCode.size(), ReferenceKind::DEFINITION, data);
+            defineSymbol(entry.label, (Address)data.locationCounter, data);
+        }
+        IntermediateCodeLine ic;
+        ic.lineNumber = lineNum;
+        ic.locationCounter = (Address)data.locationCounter;
+        ic.type = c.type;
+        ic.opcode = c.opcode;
+        ic.operand1Type = c.operand1Type;
+        ic.operand1Value = c.operand1Value;
+        ic.operand2Type = c.operand2Type;
+        if (c.operand2Type == OperandKind::S) {
+            ic.operand2Value = symbol(c.operand2Value);
+            addReference(ic.operand2Value, lineNum, data.intermediateCode.size(), ReferenceKind::OPERAND, data);
+        } else if (c.operand2Type == OperandKind::L) ic.operand2Value = addLiteral(old.literalText(c.operand2Value), data);
+        else ic.operand2Value = c.operand2Value;
+        entry.operand2Value = ic.operand2Value;
+        data.intermediateCode.push_back(ic);
+        data.locationCounter += c.lcDelta;
+        checkLocationCounter(lineNum, data);
+    }
+    resolveDeferredEqus(data);   // a source without END
+    buildSegmentMap(data);
+    return true;
+}
+
+// ============================================================================
+// SEGMENT MAP
+// ============================================================================
+
+/**
+ * Maps the populated parts of the address space
+ * Every IS/DC word, DS reservation and placed literal is a piece; pieces are
+ * coalesced in emission order (nearly always contiguous), then the few runs
+ * left are sorted and merged. Cost follows the code, not the address span.
+ * @param data Assembler data with IC and literal addresses (segments replaced)
+ */
+void buildSegmentMap(AssemblerData& data) {
+    // The pieces are collected in data.segments itself and merged in place
+    std::pmr::vector<Segment>& pieces = data.segments;
+    pieces.clear();
+    auto add = [&pieces](std::int64_t base, std::int64_t length, std::uint32_t words) {
+        if (length <= 0 || base < 0 || base >= ADDRESS_END) return;
+        length = std::min(length, ADDRESS_END - base);
+        if (!pieces.empty() && (std::int64_t)pieces.back().base + pieces.back().length == base &&
+            pieces.back().length + length <= ADDRESS_END) {
+            pieces.back().length += (std::uint32_t)length;
+            pieces.back().words += words;
+            return;
+        }
+        pieces.push_back(Segment{(Address)base, (std::uint32_t)length, words});
+    };
+    for (const IntermediateCodeLine& ic : data.intermediateCode) {
+        if (ic.type == ICType::AD) continue;
+        if (ic.type == ICType::DL && ic.opcode == 1) add(ic.locationCounter, ic.operand1Value, 0); // DS
+        else add(ic.locationCounter, 1, 1);
+    }
+    for (const LiteralTableEntry& L : data.literalTable)
+        if (L.address != NO_ADDRESS) add(L.address, 1, 1);
+
+    std::sort(pieces.begin(), pieces.end(), [](const Segment& a, const Segment& b) { return a.base < b.base; });
+    size_t kept = 0;
+    for (size_t i = 0; i < pieces.size(); ++i) {
+        const Segment p = pieces[i];
+        if (kept > 0) {
+            Segment& last = pieces[kept - 1];
+            const std::int64_t end = (std::int64_t)last.base + last.length;
+            if (p.base <= end) {  // touching or overlapping (ORIGIN back over earlier code)
+                last.length = (std::uint32_t)(std::max(end, (std::int64_t)p.base + p.length) - last.base);
+                last.words += p.words;
+                continue;
+            }
+        }
+        pieces[kept++] = p;
+    }
+    pieces.resize(kept);
+}
+
+// ============================================================================
+// PASS 1 MAIN FUNCTIONS
+// ============================================================================
+
+/**
+ * Pass 1 over a source held in memory (the embedding API)
+ * Lines are cut straight out of `source`; nothing is copied or read
+ * @param source The whole program text
+ * @param data Reference to assembler data structure (modified)
+ * @return false if the program has errors (see data.errors)
+ */
+bool pass1Source(string_view source, AssemblerData& data) {
+    asmscan::LineScanner scan;
+    scan.reset(source.data(), source.size());
+    string_view line;
+    asmscan::LineBits bits;
+    int lineNum = 0;
+    while (scan.next(line, bits)) processLine(line, bits, ++lineNum, data);
+    resolveDeferredEqus(data);   // a source without END
+    buildSegmentMap(data);
+    return data.errors.empty();
+}
+
+/**
+ * Assembles one lexed statement (the one-pass driver's entry into pass 1)
+ * @param sl The lexed source line (mnemonic must not be empty)
+ * @param lineNum The line number (for error reporting)
+ * @param data Reference to assembler data structure (modified)
+ */
+void pass1Statement(const SourceLine& sl, int lineNum, AssemblerData& data) {
+    processSourceLine(sl, lineNum, data);
+}
+
+/**
+ * Ends a pass fed through pass1Statement: resolves the EQUs still deferred
+ * (a source without END) and reports the ones that cannot be
+ * @param data Reference to assembler data structure (modified)
+ */
+void pass1Finish(AssemblerData& data) {
+    resolveDeferredEqus(data);
+}
+
+#ifndef ASM_NO_STATS
+/**
+ * The serial pass 1 loop with each phase timed per line (--stats)
+ * Three clock reads per line; only runs when data.stats is set
+ * @param in The opened source
+ * @param data Reference to assembler data structure (modified)
+ */
+static void pass1Timed(LineReader& in, AssemblerData& data) {
+    using Clock = std::chrono::steady_clock;
+    Pass1Stats& s = *data.stats;
+    Clock::duration read{}, lex{}, process{};
+    string_view line;
+    asmscan::LineBits bits;
+    for (Clock::time_point t0 = Clock::now();;) {
+        const bool more = in.next(line, bits);
+        const Clock::time_point t1 = Clock::now();
+        read += t1 - t0;
+        if (!more) break;
+        ++s.lines;
+        const SourceLine sl = lexSourceLine(line, bits, data);
+        const Clock::time_point t2 = Clock::now();
+        lex += t2 - t1;
+        if (!sl.mnemonic.empty()) {
+            ++s.statements;
+            processSourceLine(sl, (int)in.lineNumber(), data);
+        }
+        t0 = Clock::now();
+        process += t0 - t2;
+    }
+    const Clock::time_point t3 = Clock::now();
+    resolveDeferredEqus(data);
+    buildSegmentMap(data);
+    process += Clock::now() - t3;
+
+    auto ms = [](Clock::duration d) { return std::chrono::duration<double, std::milli>(d).count(); };
+    s.readMs += ms(read);
+    s.tokenizeMs += ms(lex);
+    s.processMs += ms(process);
+}
+#endif
+
+/**
+ * Performs Pass 1 entirely in memory
  * - Reads source code and processes each line
- * - Builds symbol table, literal table, and intermediate code
- * - Writes output files for Pass 2
- * 
- * @param inputFile Path to the source assembly file
- * @param intermediateFile Path to write intermediate code
- * @param symbolFile Path to write symbol table
- * @param literalFile Path to write literal table
+ * - Builds symbol table, literal table, and intermediate code inside `data`
+ * - Writes nothing; pass2(data, ...) can consume the result directly
+ *
+ * @param inputFile Path to the source assembly file ("-" for stdin)
  * @param data Reference to assembler data structure (modified)
+ * @param threads Threads for the parallel pass (1 = serial; same result either way)
+ * @return false if the source file could not be opened
  */
-void pass1(const std::string& inputFile, const std::string& intermediateFile,
-           const std::string& symbolFile, const std::string& literalFile, 
-           AssemblerData& data) {
-    
-    // ========== STEP 1: Open and read input file ==========
-    std::ifstream in(inputFile);
-    if (!in.is_open()) {
+bool pass1(const std::string& inputFile, AssemblerData& data, unsigned threads) {
+#ifndef ASM_NO_STATS
+    if (data.stats) threads = 1;     // phases are timed per line, serially
+#endif
+    // More than one thread: speculative parallel pass over the mapped file
+    if (threads > 1 && pass1Parallel(inputFile, data, threads)) {
+        resolveDeferredEqus(data);   // a source without END
+        buildSegmentMap(data);
+        return true;
+    }
+
+    // Regular files are memory-mapped; pipes and "-" (stdin) are read in blocks
+    LineReader in;
+    if (!in.open(inputFile)) {
         std::cerr << "Error: Cannot open " << inputFile << "\n";
-        return;
+        return false;
     }
-    
-    // Process each line of the source file
-    string line;
-    int ln = 1; // Line number counter
-    while (std::getline(in, line)) {
-        processLine(line, ln++, data);
+
+#ifndef ASM_NO_STATS
+    if (data.stats) {
+        pass1Timed(in, data);
+        return true;
+    }
+#endif
+
+    // Process each line of the source file (line numbers are 1-based)
+    string_view line;
+    asmscan::LineBits bits;
+    while (in.next(line, bits)) {
+        processLine(line, bits, (int)in.lineNumber(), data);
     }
-    in.close();
+    resolveDeferredEqus(data);   // a source without END still gets its EQUs resolved
+    buildSegmentMap(data);
+    return true;
+}
 
-    // ========== STEP 2: Write intermediate code file ==========
+/**
+ * Serializes the Pass 1 tables to the text files read by the file-based pass2()
+ * @param data Assembler data filled by pass1
+ * @param intermediateFile Path to write intermediate code
+ * @param symbolFile Path to write symbol table
+ * @param literalFile Path to write literal table
+ */
+void writePass1Outputs(const AssemblerData& data, const std::string& intermediateFile,
+                       const std::string& symbolFile, const std::string& literalFile) {
+    // ========== STEP 1: Write intermediate code file ==========
     std::ofstream ic(intermediateFile);
     for (const auto& x : data.intermediateCode) {
         // Format: LC (TYPE,OPCODE) (OP1TYPE,OP1VAL) (OP2TYPE,OP2VAL)
-        ic << x.locationCounter << " (" << x.type << "," << x.opcode << ")";
+        ic << x.locationCounter << " (" << icTypeName(x.type) << "," << (int)x.opcode << ")";
         
         // Add first operand if present
-        if (!x.operand1Type.empty()) {
-            ic << " (" << x.operand1Type << "," << x.operand1Value << ")";
+        if (x.operand1Type != OperandKind::NONE) {
+            ic << " (" << operandKindName(x.operand1Type) << "," << x.operand1Value << ")";
         }
         
-        // Add second operand if present
-        if (!x.operand2Type.empty()) {
-            ic << " (" << x.operand2Type << "," << x.operand2Value << ")";
+        // Add second operand if present (symbols are written by name)
+        if (x.operand2Type == OperandKind::S) {
+            ic << " (S," << data.symbolIds.name(x.operand2Value) << ")";
+        } else if (x.operand2Type != OperandKind::NONE) {
+            ic << " (" << operandKindName(x.operand2Type) << "," << x.operand2Value << ")";
         }
         
         ic << "\n";
     }
     ic.close();
 
-    // ========== STEP 3: Write symbol table file ==========
+    // ========== STEP 2: Write symbol table file ==========
     std::ofstream st(symbolFile);
-    for (const auto& p : data.symbolTable) {
-        // Format: SYMBOL ADDRESS LENGTH
-        st << p.second.symbol << " " 
-           << p.second.address << " " 
-           << p.second.length << "\n";
+    for (std::uint32_t id : symbolsByName(data)) {
+        // Format: SYMBOL ADDRESS LENGTH (sorted by name)
+        st << data.symbolIds.name(id) << " " 
+           << data.symbolTable[id].address << " " 
+           << data.symbolTable[id].length << "\n";
     }
     st.close();
 
-    // ========== STEP 4: Write literal table file ==========
+    // ========== STEP 3: Write literal table file ==========
     std::ofstream lt(literalFile);
     for (size_t i = 0; i < data.literalTable.size(); ++i) {
         // Format: INDEX LITERAL VALUE ADDRESS
         lt << i << " " 
-           << data.literalTable[i].literal << " " 
+           << data.literalText(i) << " " 
            << data.literalTable[i].value << " " 
-           << data.literalTable[i].address << "\n";
+           << printedAddress(data.literalTable[i].address) << "\n";
     }
     lt.close();
+}
+
+/**
+ * Performs Pass 1 of the two-pass assembler and writes its output files
+ * (in-memory pass1 followed by writePass1Outputs)
+ * 
+ * @param inputFile Path to the source assembly file
+ * @param intermediateFile Path to write intermediate code
+ * @param symbolFile Path to write symbol table
+ * @param literalFile Path to write literal table
+ * @param data Reference to assembler data structure (modified)
+ */
+void pass1(const std::string& inputFile, const std::string& intermediateFile,
+           const std::string& symbolFile, const std::string& literalFile, 
+           AssemblerData& data) {
+    if (!pass1(inputFile, data)) return;
+    writePass1Outputs(data, intermediateFile, symbolFile, literalFile);
 
-    // ========== STEP 5: Print completion message ==========
     std::cout << "PASS 1 COMPLETED\n";
     std::cout << "Intermediate: " << intermediateFile << "\n"
               << "Symbols: " << symbolFile << "\n"
               << "Literals: " << literalFile << "\n";
-}
\ No newline at end of file
+}
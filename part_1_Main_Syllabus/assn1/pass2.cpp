@@ -1,13 +1,23 @@
 // pass2.cpp — generates machine code from the outputs of Pass 1
 // Inputs  : intermediate.txt, symbol_table.txt, literal_table.txt
-// Output  : output.txt (addressed machine code)
+//           (or the in-memory AssemblerData built by pass1,
+//            or a mapped intermediate.bin, or an incremental cache)
+// Output  : output.txt (addressed machine code), or an ObjectModule
+//           (relocatable object, see objfile.hpp)
 // Depends : assembler.hpp (shared data structures + declarations)
 
 #include "assembler.hpp"
+#include "icfile.hpp"
+#include "inccache.hpp"
+#include "objfile.hpp"
+#include "../../common/asm_lexer.hpp"
+#include "../../common/format_int.hpp"
+#include "../../common/line_reader.hpp"
+#include "../../common/thread_pool.hpp"
+#include <algorithm>
 #include <fstream>
-#include <sstream>
-#include <iomanip>
 #include <iostream>
+#include <vector>
 
 using std::string;
 
@@ -15,33 +25,92 @@ using std::string;
 // Helpers to load Pass 1 outputs
 // -----------------------------
 
+// The loaders walk the mapped file line by line (common/line_reader.hpp) and
+// take numbers with asmlex::parseInt (from_chars): no iostreams, no locale,
+// no exceptions. A record that does not parse ends its table, as before.
+
 // Load symbol table produced by pass1: lines like
 //   <symbol> <address> <length>
+// Symbols get IDs in file order; the IC loader maps (S,NAME) onto them.
 static void loadSymbolTable(const string& filename, AssemblerData& data) {
-    std::ifstream f(filename);
-    if (!f.is_open()) {
+    LineReader in;
+    if (!in.open(filename)) {
         std::cerr << "Error: Cannot open " << filename << "\n";
         return;
     }
-    string symbol; int address, length;
-    // Fill/overwrite entries in data.symbolTable
-    while (f >> symbol >> address >> length) {
-        data.symbolTable[symbol] = SymbolTableEntry(symbol, address, length);
+    std::string_view line, f[3];
+    while (in.next(line)) {
+        if (asmlex::tokenize(line, f, 3, false) < 3) break;
+        std::int64_t address;
+        int length;
+        if (asmlex::parseInt(f[1], address) != std::errc() || asmlex::parseInt(f[2], length) != std::errc()) break;
+        data.symbolTable[addSymbolId(data, f[0])] = SymbolTableEntry((Address)address, length);
     }
 }
 
 // Load literal table produced by pass1: lines like
 //   <index> <literal> <value> <address>
-// Note: we ignore the incoming index and push in file order.
+// Note: we ignore the incoming index and push in file order; address -1 = unassigned.
 static void loadLiteralTable(const string& filename, AssemblerData& data) {
-    std::ifstream f(filename);
-    if (!f.is_open()) {
+    LineReader in;
+    if (!in.open(filename)) {
         std::cerr << "Error: Cannot open " << filename << "\n";
         return;
     }
-    int index, value, address; string literal;
-    while (f >> index >> literal >> value >> address) {
-        data.literalTable.push_back(LiteralTableEntry(literal, value, address));
+    std::string_view line, f[4];
+    while (in.next(line)) {
+        if (asmlex::tokenize(line, f, 4, false) < 4) break;
+        int index, value;
+        std::int64_t address;
+        if (asmlex::parseInt(f[0], index) != std::errc() || asmlex::parseInt(f[2], value) != std::errc() ||
+            asmlex::parseInt(f[3], address) != std::errc())
+            break;
+        data.literalTable.push_back(LiteralTableEntry(data.literalTexts.intern(f[1]), value, address < 0 ? NO_ADDRESS : (Address)address));
+    }
+}
+
+static ICType parseICType(std::string_view s) {
+    if (s == "IS") return ICType::IS;
+    if (s == "DL") return ICType::DL;
+    return ICType::AD;
+}
+
+static OperandKind parseOperandKind(std::string_view s) {
+    if (s == "R")  return OperandKind::R;
+    if (s == "CC") return OperandKind::CC;
+    if (s == "C")  return OperandKind::C;
+    if (s == "S")  return OperandKind::S;
+    if (s == "L")  return OperandKind::L;
+    return OperandKind::NONE;
+}
+
+// A number field of an IC tuple; 0 if it does not parse
+static int toInt(std::string_view s) {
+    int v = 0;
+    return asmlex::parseInt(s, v) == std::errc() ? v : 0;
+}
+
+// Splits "(KIND,VALUE)" into its two fields; false if the token has no ','
+static bool splitTuple(std::string_view token, std::string_view& kind, std::string_view& value) {
+    size_t c = token.find(',');
+    if (c == std::string_view::npos || token.size() < c + 2) return false;
+    kind = token.substr(1, c - 1);                      // skip '('
+    value = token.substr(c + 1, token.size() - c - 2);  // drop trailing ')'
+    return true;
+}
+
+// Parse "(KIND,VALUE)" into a packed operand; symbol names become IDs
+// (-1 if the symbol table does not know the name).
+static void parseOperand(std::string_view token, const AssemblerData& data,
+                         OperandKind& kind, std::int32_t& value) {
+    std::string_view k, v;
+    if (!splitTuple(token, k, v)) return;
+    kind = parseOperandKind(k);
+    if (kind == OperandKind::S) {
+        std::uint32_t id = data.symbolIds.find(v);
+        value = (id != SymbolInterner::npos) ? (std::int32_t)id : -1;
+    } else {
+        value = toInt(v);
     }
 }
 
@@ -51,50 +120,48 @@ static void loadLiteralTable(const string& filename, AssemblerData& data) {
 //   <LC> (AD,01) (C,100)
 // The format is stable: LC, then up to three parenthesized tokens.
 static void loadIntermediateCode(const string& filename, AssemblerData& data) {
-    std::ifstream f(filename);
-    if (!f.is_open()) {
+    LineReader in;
+    if (!in.open(filename)) {
         std::cerr << "Error: Cannot open " << filename << "\n";
         return;
     }
-    string line;
-    while (std::getline(f, line)) {
-        if (line.empty()) continue;
+    std::string_view line, f[4];
+    while (in.next(line)) {
+        // First field is always LC (location counter), then "(TYPE,OP)" and up to two operands
+        const int n = asmlex::tokenize(line, f, 4, false);
+        if (n < 2) continue;
 
         IntermediateCodeLine ic;
-        std::istringstream iss(line);
-
-        // First field is always LC (location counter)
-        iss >> ic.locationCounter;
+        if (asmlex::parseInt(f[0], ic.locationCounter) != std::errc()) continue;
 
-        // Next token must be like "(IS,04)" or "(AD,03)" or "(DL,02)"
-        string token;
-        if (!(iss >> token)) continue;
-
-        // Parse "(TYPE,OP)" -> TYPE=IS/AD/DL, OP is numeric code as string
-        {
-            size_t c = token.find(',');
-            ic.type   = token.substr(1, c - 1);                   // skip '('
-            ic.opcode = token.substr(c + 1, token.size() - c - 2); // drop trailing ')'
-        }
+        // Parse "(TYPE,OP)" -> TYPE=IS/AD/DL, OP is the numeric code
+        std::string_view type, op;
+        if (!splitTuple(f[1], type, op)) continue;
+        ic.type   = parseICType(type);
+        ic.opcode = (std::uint8_t)toInt(op);
 
         // Optional operand1 like "(R,1)" or "(CC,3)" or "(C,10)"
-        if (iss >> token) {
-            size_t c = token.find(',');
-            ic.operand1Type  = token.substr(1, c - 1);
-            ic.operand1Value = token.substr(c + 1, token.size() - c - 2);
-        }
+        if (n > 2) parseOperand(f[2], data, ic.operand1Type, ic.operand1Value);
 
         // Optional operand2 like "(S,LOOP)" or "(L,0)"
-        if (iss >> token) {
-            size_t c = token.find(',');
-            ic.operand2Type  = token.substr(1, c - 1);
-            ic.operand2Value = token.substr(c + 1, token.size() - c - 2);
-        }
+        if (n > 3) parseOperand(f[3], data, ic.operand2Type, ic.operand2Value);
 
         data.intermediateCode.push_back(ic);
     }
 }
 
+// Everything code generation needs, whether it comes from pass1's memory
+// or straight out of a mapped intermediate.bin.
+struct Pass2Input {
+    const IntermediateCodeLine* code = nullptr;
+    size_t codeCount = 0;
+    const Address* symbolAddress = nullptr;        // by symbol ID
+    size_t symbolCount = 0;
+    const std::int32_t* literalValue = nullptr;
+    const Address* literalAddress = nullptr;
+    size_t literalCount = 0;
+};
+
 // -----------------------------------
 // PASS 2 — generate addressed machine code
 // -----------------------------------
@@ -108,105 +175,344 @@ static void loadIntermediateCode(const string& filename, AssemblerData& data) {
 //     * DC: defines constant — we emit a data word with that value.
 // - Finally, we also output literal values at their assigned addresses
 //   (useful when pass1 allocated literals via LTORG/END).
-//
-void pass2(const std::string& intermediateFile, const std::string& symbolFile,
-           const std::string& literalFile, const std::string& outputFile, AssemblerData& data) {
 
-    // Bring in all the artifacts from Pass 1
-    loadSymbolTable(symbolFile, data);
-    loadLiteralTable(literalFile, data);
-    loadIntermediateCode(intermediateFile, data);
+// Listing text of one IC record up to its address field (see assembler.hpp)
+bool formatListingHead(const IntermediateCodeLine& ic, string& buf) {
+    // AD = assembler directives START/END/ORIGIN/EQU/LTORG — no code emitted
+    if (ic.type == ICType::AD) return false;
 
-    // Prepare the output listing file
-    std::ofstream out(outputFile);
+    // Print the address first (4 digits, zero-padded)
+    appendInt(buf, ic.locationCounter, 4);
+    buf += "     ";
+
+    if (ic.type == ICType::IS) {
+        // Imperative statement: +<opcode> <r/cc> <address>
+        buf += '+';
+        appendInt(buf, ic.opcode, 2);
+
+        // Operand 1: register or condition code; if absent -> 0
+        if (ic.operand1Type == OperandKind::R || ic.operand1Type == OperandKind::CC) {
+            buf += ' ';
+            appendInt(buf, ic.operand1Value);
+        } else {
+            buf += " 0";
+        }
+        buf += ' ';
+        return true;    // the address field is the caller's
+    }
+
+    // Declaratives
+    if (ic.opcode == 1) { // DS — reserve N locations; emit placeholders at each LC+i
+        int size = ic.operand1Value;
+        for (int i=0;i<size;i++) {
+            if (i>0) {
+                buf += '\n';
+                appendInt(buf, (long long)ic.locationCounter + i, 4);
+                buf += "     ";
+            }
+            buf += "+00 0 0000"; // placeholder word
+        }
+    } else if (ic.opcode == 2) { // DC — define constant; emit value in address field
+        buf += "+00 0 ";
+        appendInt(buf, ic.operand1Value, 4);
+    } else {
+        // Unknown DL variant — emit a safe placeholder
+        buf += "+00 0 0000";
+    }
+    buf += '\n';
+    return false;
+}
+
+// Formats IC records [begin, end) into `buf`. Pure function of `in`, so any
+// number of ranges can be formatted at once and concatenated afterwards.
+static void formatRange(const Pass2Input& in, size_t begin, size_t end, string& buf) {
+    for (size_t n = begin; n < end; ++n) {
+        const IntermediateCodeLine& ic = in.code[n];
+        if (!formatListingHead(ic, buf)) continue;
+
+        // Operand 2: address field resolved from symbol (S) or literal (L);
+        // 0000 if there is no second operand / unknown symbol / bad index
+        Address address = 0;
+        const std::int32_t idx = ic.operand2Value;
+        if (ic.operand2Type == OperandKind::S && idx >= 0 && (size_t)idx < in.symbolCount) {
+            address = in.symbolAddress[idx];    // symbol ID -> absolute address
+        } else if (ic.operand2Type == OperandKind::L && idx >= 0 && (size_t)idx < in.literalCount) {
+            address = in.literalAddress[idx];   // literal index -> literal address
+        }
+        appendInt(buf, address, 4);
+        buf += '\n';
+    }
+}
+
+// One literal pool word: "<address>     +00 0 <value>"
+void formatLiteralWord(Address address, std::int32_t value, string& buf) {
+    appendInt(buf, address, 4);
+    buf += "     +00 0 ";
+    appendInt(buf, value, 4);
+    buf += '\n';
+}
+
+// Emit literal pool values (if pass1 assigned addresses via LTORG/END)
+// Each literal becomes a data word: "+00 0 <value>"
+static void formatLiteralPool(const Pass2Input& in, string& buf) {
+    for (size_t i = 0; i < in.literalCount; ++i)
+        if (in.literalAddress[i] != NO_ADDRESS) formatLiteralWord(in.literalAddress[i], in.literalValue[i], buf);
+}
+
+const char MACHINE_CODE_HEADER[] = "ADDRESS  MACHINE CODE\n==============================\n";
+
+// IC records per work item, and work items in flight per worker. Output is
+// written one wave at a time, so memory stays bounded for any input size.
+static const size_t kChunkRecords = 16384;
+static const size_t kChunksPerThread = 4;
+
+// With threads > 1 the IC is cut into fixed chunks that workers format into
+// private buffers; buffers are written back in chunk order, so the listing is
+// byte-for-byte the same as a single-threaded run.
+static void generateMachineCode(const Pass2Input& in, std::ostream& out, unsigned threads) {
+    // Simple header for human-readable output
+    out << MACHINE_CODE_HEADER;
+
+    ThreadPool pool(threads);
+    const size_t chunks = (in.codeCount + kChunkRecords - 1) / kChunkRecords;
+    std::vector<string> buffers(std::min(chunks, pool.size() * kChunksPerThread));
+    for (size_t first = 0; first < chunks; first += buffers.size()) {
+        const size_t wave = std::min(buffers.size(), chunks - first);
+        pool.parallelFor(wave, [&](size_t i) {
+            const size_t begin = (first + i) * kChunkRecords;
+            buffers[i].clear();
+            formatRange(in, begin, std::min(in.codeCount, begin + kChunkRecords), buffers[i]);
+        });
+        for (size_t i = 0; i < wave; ++i) out.write(buffers[i].data(), (std::streamsize)buffers[i].size());
+    }
+
+    string buf;
+    formatLiteralPool(in, buf);
+    out.write(buf.data(), (std::streamsize)buf.size());
+}
+
+static bool openOutput(std::ofstream& out, const string& outputFile) {
+    out.open(outputFile);
     if (!out.is_open()) {
         std::cerr << "Error: Cannot create " << outputFile << "\n";
-        return;
+        return false;
     }
+    return true;
+}
 
-    // Simple header for human-readable output
-    out << "ADDRESS  MACHINE CODE\n";
-    out << "==============================\n";
-
-    // Convert each intermediate instruction to final code
-    for (const auto& ic : data.intermediateCode) {
-        // AD = assembler directives START/END/ORIGIN/EQU/LTORG — no code emitted
-        if (ic.type == "AD") {
-            if (ic.opcode=="1"||ic.opcode=="2"||ic.opcode=="3"||ic.opcode=="4"||ic.opcode=="5")
-                continue;
-        }
+// Pass2Input over pass1's tables in `data`
+// Flattens the tables into ID-indexed arrays (kept alive by `tables`) so each operand is one array index
+static Pass2Input flattenTables(const AssemblerData& data, FlatTables& tables) {
+    tables.symbolAddress.clear();
+    tables.literalAddress.clear();
+    tables.literalValue.clear();
+    tables.symbolAddress.reserve(data.symbolTable.size());
+    for (const auto& e : data.symbolTable) tables.symbolAddress.push_back(e.address);
+    for (const auto& L : data.literalTable) {
+        tables.literalValue.push_back(L.value);
+        tables.literalAddress.push_back(L.address);
+    }
 
-        // Print the address first (4 digits, zero-padded)
-        out << std::setw(4) << std::setfill('0') << ic.locationCounter << "     ";
+    Pass2Input in;
+    in.code = data.intermediateCode.data();
+    in.codeCount = data.intermediateCode.size();
+    in.symbolAddress = tables.symbolAddress.data();
+    in.symbolCount = tables.symbolAddress.size();
+    in.literalValue = tables.literalValue.data();
+    in.literalAddress = tables.literalAddress.data();
+    in.literalCount = tables.literalValue.size();
+    return in;
+}
 
-        if (ic.type == "IS") {
-            // Imperative statement: +<opcode> <r/cc> <address>
-            out << "+";
-            out << std::setw(2) << std::setfill('0') << ic.opcode;
+// Works directly on the tables pass1 left in `data`; nothing is re-parsed.
+bool pass2(const AssemblerData& data, const std::string& outputFile, unsigned threads) {
+    FlatTables tables;
+    const Pass2Input in = flattenTables(data, tables);
 
-            // Operand 1: register or condition code; if absent -> 0
-            if (!ic.operand1Type.empty() && (ic.operand1Type=="R" || ic.operand1Type=="CC")) {
-                out << " " << ic.operand1Value;
-            } else {
-                out << " 0";
-            }
+    // Prepare the output listing file
+    std::ofstream out;
+    if (!openOutput(out, outputFile)) return false;
+    generateMachineCode(in, out, threads);
+    return true;
+}
 
-            // Operand 2: address field resolved from symbol (S) or literal (L)
-            if (!ic.operand2Type.empty()) {
-                if (ic.operand2Type == "S") {
-                    // Resolve symbol -> absolute address
-                    auto it = data.symbolTable.find(ic.operand2Value);
-                    if (it != data.symbolTable.end())
-                        out << " " << std::setw(4) << std::setfill('0') << it->second.address;
-                    else
-                        out << " 0000"; // unknown symbol fallback
-                } else if (ic.operand2Type == "L") {
-                    // Resolve literal index -> literal address
-                    int idx = -1;
-                    try { idx = std::stoi(ic.operand2Value); } catch (...) {}
-                    if (idx >= 0 && idx < (int)data.literalTable.size())
-                        out << " " << std::setw(4) << std::setfill('0') << data.literalTable[idx].address;
-                    else
-                        out << " 0000"; // bad index fallback
-                } else {
-                    out << " 0000";     // unsupported operand type
-                }
-            } else {
-                out << " 0000";         // no second operand
-            }
-        }
-        else if (ic.type == "DL") {
-            // Declaratives
-            if (ic.opcode == "1") { // DS — reserve N locations; emit placeholders at each LC+i
-                int size = 0; try { size = std::stoi(ic.operand1Value); } catch (...) {}
-                for (int i=0;i<size;i++) {
-                    if (i>0) out << "\n" << std::setw(4) << std::setfill('0') << (ic.locationCounter + i) << "     ";
-                    out << "+00 0 0000"; // placeholder word
-                }
-            } else if (ic.opcode == "2") { // DC — define constant; emit value in address field
-                int val = 0; try { val = std::stoi(ic.operand1Value); } catch (...) {}
-                out << "+00 0 " << std::setw(4) << std::setfill('0') << val;
-            } else {
-                // Unknown DL variant — emit a safe placeholder
-                out << "+00 0 0000";
+// Embedding API: the listing goes into a caller-owned string, on this thread.
+// The flattened tables are kept in `data`, so a reused context allocates
+// nothing here once `listing` and the tables have grown.
+void pass2Listing(AssemblerData& data, std::string& listing) {
+    const Pass2Input in = flattenTables(data, data.flatTables);
+    listing.assign(MACHINE_CODE_HEADER);
+    formatRange(in, 0, in.codeCount, listing);
+    formatLiteralPool(in, listing);
+}
+
+bool assemble(std::string_view source, AssemblerData& data, std::string& listing) {
+    data.reset();
+    const bool clean = pass1Source(source, data);
+    pass2Listing(data, listing);
+    return clean;
+}
+
+// Generates machine code straight from a mapped intermediate.bin
+bool pass2FromBinary(const std::string& binaryFile, const std::string& outputFile, unsigned threads) {
+    BinaryICFile bin;
+    string error;
+    if (!bin.open(binaryFile, error)) {
+        std::cerr << "Error: " << error << "\n";
+        return false;
+    }
+
+    Pass2Input in;
+    in.code = bin.code();
+    in.codeCount = bin.header().icCount;
+    in.symbolAddress = bin.symbolAddress();
+    in.symbolCount = bin.header().symbolCount;
+    in.literalValue = bin.literalValue();
+    in.literalAddress = bin.literalAddress();
+    in.literalCount = bin.header().literalCount;
+
+    std::ofstream out;
+    if (!openOutput(out, outputFile)) return false;
+    generateMachineCode(in, out, threads);
+    return true;
+}
+
+// Appends one word at `address`, opening a new run unless it directly follows the last one
+static void emitWord(ObjectModule& obj, Address address, const ObjWord& w) {
+    if (obj.runs.empty() || obj.runs.back().kind != ObjRunKind::WORDS ||
+        (long long)obj.runs.back().address + obj.runs.back().wordCount != address) {
+        obj.runs.push_back(ObjRun{address, (std::uint32_t)obj.words.size(), 0, ObjRunKind::WORDS, {}});
+    }
+    obj.words.push_back(w);
+    ++obj.runs.back().wordCount;
+}
+
+// Same rules as formatRange, but the words are kept packed, every address
+// resolved through a defined relocatable symbol or a literal gets a relocation
+// record (an absolute EQU or an undefined symbol's placeholder does not), and a DS is a single RESERVE run rather than a
+// word per reserved cell.
+void buildObject(const AssemblerData& data, ObjectModule& obj) {
+    FlatTables tables;
+    const Pass2Input in = flattenTables(data, tables);
+
+    obj = ObjectModule();
+    obj.origin = data.startingAddress;
+    obj.words.reserve(in.codeCount + in.literalCount);
+    for (size_t n = 0; n < in.codeCount; ++n) {
+        const IntermediateCodeLine& ic = in.code[n];
+        if (ic.type == ICType::AD) continue;
+
+        ObjWord w;
+        if (ic.type == ICType::IS) {
+            w.kind = ObjWordKind::INSTRUCTION;
+            w.opcode = ic.opcode;
+            if (ic.operand1Type == OperandKind::R || ic.operand1Type == OperandKind::CC)
+                w.reg = (std::uint8_t)ic.operand1Value;
+
+            const std::int32_t idx = ic.operand2Value;
+            if (ic.operand2Type == OperandKind::S && idx >= 0 && (size_t)idx < in.symbolCount) {
+                w.operand = (std::int32_t)in.symbolAddress[idx];
+                if (data.symbolTable[idx].defined && !data.symbolTable[idx].absolute)
+                    obj.relocations.push_back(ObjRelocation{(std::uint32_t)obj.words.size(), idx});
+            } else if (ic.operand2Type == OperandKind::L && idx >= 0 && (size_t)idx < in.literalCount) {
+                w.operand = (std::int32_t)in.literalAddress[idx];
+                obj.relocations.push_back(ObjRelocation{(std::uint32_t)obj.words.size(), -1});
             }
+            emitWord(obj, ic.locationCounter, w);
+        } else if (ic.opcode == 1) { // DS — one zero-fill range, however many words it reserves
+            const std::uint32_t size = ic.operand1Value > 0 ? (std::uint32_t)ic.operand1Value : 0;
+            obj.runs.push_back(ObjRun{ic.locationCounter, (std::uint32_t)obj.words.size(), size, ObjRunKind::RESERVE, {}});
         } else {
-            // Unknown type — keep output shape stable
-            out << "+00 0 0000";
+            if (ic.opcode == 2) { // DC
+                w.kind = ObjWordKind::CONSTANT;
+                w.operand = ic.operand1Value;
+            }
+            emitWord(obj, ic.locationCounter, w);
         }
+    }
+
+    // Literal pool, as formatLiteralPool lists it
+    for (size_t i = 0; i < in.literalCount; ++i) {
+        if (in.literalAddress[i] == NO_ADDRESS) continue;
+        ObjWord w;
+        w.kind = ObjWordKind::CONSTANT;
+        w.operand = in.literalValue[i];
+        emitWord(obj, in.literalAddress[i], w);
+    }
 
-        out << "\n";
+    obj.segments.assign(data.segments.begin(), data.segments.end());
+    obj.symbolAddress.assign(tables.symbolAddress.begin(), tables.symbolAddress.end());
+    for (std::uint32_t id = 0; id < data.symbolTable.size(); ++id) {
+        obj.symbolLength.push_back(data.symbolTable[id].length);
+        const SymbolTableEntry& e = data.symbolTable[id];
+        obj.symbolFlags.push_back((e.absolute ? OBJ_SYMBOL_ABSOLUTE : 0) | (e.defined ? 0 : OBJ_SYMBOL_UNDEFINED));
+        obj.symbolName.emplace_back(data.symbolIds.name(id));
     }
+}
+
+// The value an IC record's machine code was built from besides its own fields
+// and LC: the resolved address for IS, the operand for DS/DC
+static std::int32_t resolvedField(const Pass2Input& in, const IntermediateCodeLine& ic) {
+    if (ic.type != ICType::IS) return ic.operand1Value;
+    const std::int32_t idx = ic.operand2Value;
+    if (ic.operand2Type == OperandKind::S && idx >= 0 && (size_t)idx < in.symbolCount) return (std::int32_t)in.symbolAddress[idx];
+    if (ic.operand2Type == OperandKind::L && idx >= 0 && (size_t)idx < in.literalCount) return (std::int32_t)in.literalAddress[idx];
+    return 0;
+}
 
-    // Emit literal pool values (if pass1 assigned addresses via LTORG/END)
-    // Each literal becomes a data word: "+00 0 <value>"
-    for (const auto& lit : data.literalTable) {
-        if (lit.address != -1) {
-            out << std::setw(4) << std::setfill('0') << lit.address << "     "
-                << "+00 0 " << std::setw(4) << std::setfill('0') << lit.value << "\n";
+// Incremental pass 2: a line replayed from the cache keeps its cached machine
+// code unless its LC or resolved address moved; everything else is formatted.
+bool pass2Incremental(const AssemblerData& data, const IncrementalCache& old,
+                      IncrementalRun& run, const std::string& outputFile) {
+    FlatTables tables;
+    const Pass2Input in = flattenTables(data, tables);
+
+    run.code.clear();
+    for (size_t n = 0; n < in.codeCount; ++n) {
+        const IntermediateCodeLine& ic = in.code[n];
+        if (ic.type == ICType::AD) continue;
+
+        CachedLine& entry = run.lines[ic.lineNumber - 1];
+        const std::int32_t o = run.oldLine[ic.lineNumber - 1];
+        entry.locationCounter = ic.locationCounter;
+        entry.resolved = resolvedField(in, ic);
+        entry.codeOffset = (std::uint32_t)run.code.size();
+        ++run.codeLines;
+
+        if (o >= 0 && entry.kind == CachedLineKind::CODE && old.line(o).kind == CachedLineKind::CODE &&
+            old.line(o).locationCounter == entry.locationCounter && old.line(o).resolved == entry.resolved) {
+            run.code += old.code(old.line(o));
+        } else {
+            formatRange(in, n, n + 1, run.code);
+            ++run.regenerated;
         }
+        entry.codeLength = (std::uint32_t)(run.code.size() - entry.codeOffset);
     }
 
-    out.close();
+    std::ofstream out;
+    if (!openOutput(out, outputFile)) return false;
+    string pool;
+    formatLiteralPool(in, pool);
+    out << MACHINE_CODE_HEADER;
+    out.write(run.code.data(), (std::streamsize)run.code.size());
+    out.write(pool.data(), (std::streamsize)pool.size());
+    return (bool)out;
+}
+
+// Bring in all the artifacts Pass 1 wrote to disk
+void loadPass1Outputs(const std::string& intermediateFile, const std::string& symbolFile,
+                      const std::string& literalFile, AssemblerData& data) {
+    loadSymbolTable(symbolFile, data);
+    loadLiteralTable(literalFile, data);
+    loadIntermediateCode(intermediateFile, data);
+    buildSegmentMap(data);
+}
+
+// File-based pass 2: re-reads the three text files written by pass1
+void pass2(const std::string& intermediateFile, const std::string& symbolFile,
+           const std::string& literalFile, const std::string& outputFile, AssemblerData& data,
+           unsigned threads) {
+    loadPass1Outputs(intermediateFile, symbolFile, literalFile, data);
+    if (!pass2(data, outputFile, threads)) return;
     std::cout << "PASS 2 COMPLETED\nMachine code: " << outputFile << "\n";
 }
@@ -1,41 +1,103 @@
 #include "assembler.hpp"
+#include <algorithm>
 
-void initializeTables(AssemblerData& data) {
-    // Imperative
-    data.MOT["STOP"]  = Instruction("STOP", 0, 1, InstructionType::IMPERATIVE);
-    data.MOT["ADD"]   = Instruction("ADD", 1, 1, InstructionType::IMPERATIVE);
-    data.MOT["SUB"]   = Instruction("SUB", 2, 1, InstructionType::IMPERATIVE);
-    data.MOT["MULT"]  = Instruction("MULT", 3, 1, InstructionType::IMPERATIVE);
-    data.MOT["MOVER"] = Instruction("MOVER", 4, 1, InstructionType::IMPERATIVE);
-    data.MOT["MOVEM"] = Instruction("MOVEM", 5, 1, InstructionType::IMPERATIVE);
-    data.MOT["COMP"]  = Instruction("COMP", 6, 1, InstructionType::IMPERATIVE);
-    data.MOT["BC"]    = Instruction("BC", 7, 1, InstructionType::IMPERATIVE);
-    data.MOT["DIV"]   = Instruction("DIV", 8, 1, InstructionType::IMPERATIVE);
-    data.MOT["READ"]  = Instruction("READ", 9, 1, InstructionType::IMPERATIVE);
-    data.MOT["PRINT"] = Instruction("PRINT",10, 1, InstructionType::IMPERATIVE);
-
-    // Declarative
-    data.MOT["DS"] = Instruction("DS", 1, 0, InstructionType::DECLARATIVE);
-    data.MOT["DC"] = Instruction("DC", 2, 1, InstructionType::DECLARATIVE);
-
-    // Assembler directives
-    data.MOT["START"] = Instruction("START", 1, 0, InstructionType::ASSEMBLER);
-    data.MOT["END"]   = Instruction("END",   2, 0, InstructionType::ASSEMBLER);
-    data.MOT["ORIGIN"]= Instruction("ORIGIN",3, 0, InstructionType::ASSEMBLER);
-    data.MOT["EQU"]   = Instruction("EQU",   4, 0, InstructionType::ASSEMBLER);
-    data.MOT["LTORG"] = Instruction("LTORG", 5, 0, InstructionType::ASSEMBLER);
+static constexpr OpcodeTables kTables = {
+    StaticTable<Instruction, 18>({{
+        // Imperative
+        {"STOP",  Instruction("STOP", 0, 1, InstructionType::IMPERATIVE)},
+        {"ADD",   Instruction("ADD", 1, 1, InstructionType::IMPERATIVE)},
+        {"SUB",   Instruction("SUB", 2, 1, InstructionType::IMPERATIVE)},
+        {"MULT",  Instruction("MULT", 3, 1, InstructionType::IMPERATIVE)},
+        {"MOVER", Instruction("MOVER", 4, 1, InstructionType::IMPERATIVE)},
+        {"MOVEM", Instruction("MOVEM", 5, 1, InstructionType::IMPERATIVE)},
+        {"COMP",  Instruction("COMP", 6, 1, InstructionType::IMPERATIVE)},
+        {"BC",    Instruction("BC", 7, 1, InstructionType::IMPERATIVE)},
+        {"DIV",   Instruction("DIV", 8, 1, InstructionType::IMPERATIVE)},
+        {"READ",  Instruction("READ", 9, 1, InstructionType::IMPERATIVE)},
+        {"PRINT", Instruction("PRINT",10, 1, InstructionType::IMPERATIVE)},
+
+        // Declarative
+        {"DS", Instruction("DS", 1, 0, InstructionType::DECLARATIVE)},
+        {"DC", Instruction("DC", 2, 1, InstructionType::DECLARATIVE)},
+
+        // Assembler directives
+        {"START", Instruction("START", 1, 0, InstructionType::ASSEMBLER)},
+        {"END",   Instruction("END",   2, 0, InstructionType::ASSEMBLER)},
+        {"ORIGIN",Instruction("ORIGIN",3, 0, InstructionType::ASSEMBLER)},
+        {"EQU",   Instruction("EQU",   4, 0, InstructionType::ASSEMBLER)},
+        {"LTORG", Instruction("LTORG", 5, 0, InstructionType::ASSEMBLER)},
+    }}),
 
     // Registers
-    data.REGISTERS["AREG"] = 1;
-    data.REGISTERS["BREG"] = 2;
-    data.REGISTERS["CREG"] = 3;
-    data.REGISTERS["DREG"] = 4;
+    StaticTable<int, 4>({{ {"AREG", 1}, {"BREG", 2}, {"CREG", 3}, {"DREG", 4} }}),
 
     // Condition codes
-    data.CONDITION_CODES["LT"]  = 1;
-    data.CONDITION_CODES["LE"]  = 2;
-    data.CONDITION_CODES["EQ"]  = 3;
-    data.CONDITION_CODES["GT"]  = 4;
-    data.CONDITION_CODES["GE"]  = 5;
-    data.CONDITION_CODES["ANY"] = 6;
+    StaticTable<int, 6>({{ {"LT", 1}, {"LE", 2}, {"EQ", 3}, {"GT", 4}, {"GE", 5}, {"ANY", 6} }}),
+};
+
+const OpcodeTables& opcodeTables() {
+    return kTables;
+}
+
+void initializeTables(AssemblerData& data) {
+    data.tables = &opcodeTables();
+}
+
+const char* icTypeName(ICType t) {
+    switch (t) {
+        case ICType::IS: return "IS";
+        case ICType::DL: return "DL";
+        default:         return "AD";
+    }
+}
+
+const char* operandKindName(OperandKind k) {
+    switch (k) {
+        case OperandKind::R:  return "R";
+        case OperandKind::CC: return "CC";
+        case OperandKind::C:  return "C";
+        case OperandKind::S:  return "S";
+        case OperandKind::L:  return "L";
+        default:              return "";
+    }
+}
+
+// Interns `name`, creating its symbol table entry if it is new; returns its ID
+int addSymbolId(AssemblerData& data, std::string_view name) {
+    std::uint32_t id = data.symbolIds.intern(name);
+    if (id == data.symbolTable.size()) data.symbolTable.push_back(SymbolTableEntry());
+    return (int)id;
+}
+
+// Symbol IDs ordered by name; the tables are only sorted when written out
+std::vector<std::uint32_t> symbolsByName(const AssemblerData& data) {
+    std::vector<std::uint32_t> ids(data.symbolTable.size());
+    for (std::uint32_t i = 0; i < ids.size(); ++i) ids[i] = i;
+    std::sort(ids.begin(), ids.end(), [&data](std::uint32_t a, std::uint32_t b) {
+        return data.symbolIds.name(a) < data.symbolIds.name(b);
+    });
+    return ids;
+}
+
+AssemblerData::AssemblerData(std::pmr::memory_resource* mr)
+    : arena(mr),
+      symbolIds(mr), symbolTable(mr), literalTable(mr), literalTexts(mr), poolTable(mr),
+      poolLiterals(mr), intermediateCode(mr), segments(mr), deferredEqus(mr), errors(mr),
+      references(mr), flatTables(mr) {}
+
+// Interners, vectors and the deferred EQU pool all keep their capacity
+void AssemblerData::reset() {
+    symbolIds.clear();
+    symbolTable.clear();
+    literalTable.clear();
+    literalTexts.clear();
+    poolTable.clear();
+    poolLiterals.clear();
+    intermediateCode.clear();
+    segments.clear();
+    deferredEqus.clear();
+    errors.clear();
+    references.clear();
+    locationCounter = 0;
+    startingAddress = 0;
 }
@@ -0,0 +1,440 @@
+// vm.cpp — pseudo machine interpreter (see vm.hpp)
+// Input   : output.obj or output.txt, and the program's READ input
+// Output  : the program's PRINT output; a VmResult with the instruction count
+// Depends : objfile.hpp (object loader), common/line_reader.hpp, common/asm_lexer.hpp
+
+#include "vm.hpp"
+#include "objfile.hpp"
+#include "../../common/asm_lexer.hpp"
+#include "../../common/format_int.hpp"
+#include "../../common/line_reader.hpp"
+#include <algorithm>
+#include <chrono>
+#include <climits>
+#include <cstring>
+
+using std::string;
+using std::string_view;
+
+#if defined(__GNUC__) || defined(__clang__)
+#define VM_THREADED 1      // labels as values: each handler jumps straight to the next
+#endif
+
+static const Address kPageWords = 1024;
+static const std::size_t kIoBlock = 1 << 16;
+
+namespace {
+
+// READ's source: whitespace-separated integers, read a block at a time
+class VmInput {
+public:
+    explicit VmInput(std::FILE* f) : f_(f), buf_(kIoBlock) {}
+
+    // false at the end of the input or on a token that is not an integer
+    bool next(std::int32_t& v) {
+        for (;;) {
+            while (pos_ < end_ && asmlex::isSpace(buf_[pos_])) ++pos_;
+            std::size_t e = pos_;
+            while (e < end_ && !asmlex::isSpace(buf_[e])) ++e;
+            if (pos_ < end_ && (e < end_ || eof_)) {
+                const string_view token(buf_.data() + pos_, e - pos_);
+                pos_ = e;
+                return asmlex::parseInt(token, v) == std::errc();
+            }
+            if (eof_) return false;
+            refill();
+        }
+    }
+
+private:
+    // Keeps the partial token at the front and reads behind it
+    void refill() {
+        std::memmove(buf_.data(), buf_.data() + pos_, end_ - pos_);
+        end_ -= pos_;
+        pos_ = 0;
+        if (end_ == buf_.size()) buf_.resize(buf_.size() * 2);   // one very long token
+        const std::size_t n = f_ ? std::fread(buf_.data() + end_, 1, buf_.size() - end_, f_) : 0;
+        end_ += n;
+        if (n == 0) eof_ = true;
+    }
+
+    std::FILE* f_;
+    std::vector<char> buf_;
+    std::size_t pos_ = 0, end_ = 0;
+    bool eof_ = false;
+};
+
+} // namespace
+
+// ============================================================================
+// LOADING
+// ============================================================================
+
+bool VirtualMachine::load(const string& path, string& error, bool rebase, Address base) {
+    code_.clear();
+    extra_.clear();
+    extraAt_.clear();
+    reserved_.clear();
+    pages_.clear();
+    threaded_ = false;
+    start_ = nullptr;
+    words_ = 0;
+
+    char magic[sizeof OBJECT_MAGIC] = {};
+    if (std::FILE* f = std::fopen(path.c_str(), "rb")) {
+        const std::size_t n = std::fread(magic, 1, sizeof magic, f);
+        std::fclose(f);
+        if (n == sizeof magic && std::memcmp(magic, OBJECT_MAGIC, sizeof magic) == 0)
+            return loadObject(path, error, rebase, base);
+    }
+    return loadListing(path, error);
+}
+
+bool VirtualMachine::loadObject(const string& path, string& error, bool rebase, Address base) {
+    ObjectFile file;
+    ObjectModule obj;
+    if (!file.open(path, error)) return false;
+    if (!file.relocate(rebase ? base : file.header().origin, obj, error)) return false;
+
+    std::vector<Item> items;
+    items.reserve(obj.words.size() + obj.runs.size());
+    for (const ObjRun& run : obj.runs) {
+        if (run.kind == ObjRunKind::RESERVE) {
+            items.push_back(Item{run.address, run.wordCount, true, 0, 0, 0, false});
+            continue;
+        }
+        for (std::uint32_t i = 0; i < run.wordCount; ++i) {
+            const ObjWord& w = obj.words[run.firstWord + i];
+            items.push_back(Item{run.address + i, 1, false, w.opcode, w.reg, w.operand,
+                                 w.kind == ObjWordKind::INSTRUCTION});
+        }
+    }
+    entry_ = obj.origin;
+    decode(items);
+    return true;
+}
+
+// A listing field; negatives are zero-filled in front of the sign ("00-5")
+static bool listingInt(string_view t, std::int64_t& v) {
+    const std::size_t minus = t.find('-');
+    if (minus != string_view::npos) t.remove_prefix(minus);
+    return asmlex::parseInt(t, v) == std::errc();
+}
+
+bool VirtualMachine::loadListing(const string& path, string& error) {
+    LineReader in;
+    if (!in.open(path)) {
+        error = "cannot open " + path;
+        return false;
+    }
+    std::vector<Item> items;
+    string_view line, t[6];
+    while (in.next(line)) {
+        const int n = asmlex::tokenize(line, t, 6, false);
+        if (n == 0 || !(t[0][0] >= '0' && t[0][0] <= '9')) continue;    // header lines
+        if (n == 1) continue;                                           // DS 0: an address, no word
+
+        // <address> +<opcode> <reg> <field> [x<words>]
+        std::int64_t address = 0, opcode = 0, reg = 0, field = 0, words = 1;
+        const bool ok = n >= 4 && t[1][0] == '+' && listingInt(t[0], address) && listingInt(t[1], opcode) &&
+                        listingInt(t[2], reg) && listingInt(t[3], field) &&
+                        (n == 4 || (n == 5 && t[4][0] == 'x' && listingInt(t[4].substr(1), words)));
+        if (!ok || address < 0 || address >= ADDRESS_END || opcode < 0 || opcode > 255 || reg < 0 || reg > 255 ||
+            words < 0 || address + words > ADDRESS_END) {
+            error = path + ": line " + std::to_string(in.lineNumber()) + ": not a machine code line";
+            return false;
+        }
+        if (items.empty()) entry_ = (Address)address;
+        if (n == 5) {
+            items.push_back(Item{(Address)address, (std::uint32_t)words, true, 0, 0, 0, false});
+        } else {
+            // "+00 0 v" is a constant (or STOP, the same word); anything else an instruction
+            const bool instruction = opcode != 0 || reg != 0;
+            items.push_back(Item{(Address)address, 1, false, (std::uint8_t)opcode, (std::uint8_t)reg,
+                                 (std::int32_t)field, instruction});
+        }
+    }
+    if (items.empty()) {
+        error = path + ": no machine code";
+        return false;
+    }
+    decode(items);
+    return true;
+}
+
+// ============================================================================
+// DECODING
+// ============================================================================
+
+std::int32_t* VirtualMachine::cell(Address a) {
+    std::unique_ptr<std::int32_t[]>& page = pages_[a / kPageWords];
+    if (!page) page.reset(new std::int32_t[kPageWords]());
+    return &page[a % kPageWords];
+}
+
+bool VirtualMachine::isReserved(Address a) const {
+    auto it = std::upper_bound(reserved_.begin(), reserved_.end(), a,
+                               [](Address x, const std::pair<Address, Address>& r) { return x < r.first; });
+    return it != reserved_.begin() && a < (it - 1)->second;
+}
+
+// The record executed at `a`: a decoded word, or a STOP (zero-filled range)
+// or NO_CODE fault made for that address
+const VirtualMachine::Record* VirtualMachine::recordAt(Address a) {
+    auto it = std::lower_bound(code_.begin(), code_.end(), a,
+                               [](const Record& r, Address x) { return r.address < x; });
+    if (it != code_.end() && it->address == a) return &*it;
+
+    const Record*& made = extraAt_[a];
+    if (!made) {
+        Record r;
+        r.address = a;
+        if (!isReserved(a)) {
+            r.op = Op::FAULT;
+            r.cc = NO_CODE;
+        }
+        extra_.push_back(r);
+        made = &extra_.back();
+    }
+    return made;
+}
+
+// Decodes one word's operands; code_ is complete, so records can point into it
+void VirtualMachine::link(Record& r, const Item& w) {
+    auto fault = [&r](Fault f, unsigned detail) {
+        r.op = Op::FAULT;
+        r.cc = f;
+        r.detail = (std::uint16_t)detail;
+    };
+    const Address address = (Address)w.operand;
+    switch (w.opcode) {
+    case 0:                             // STOP, and every data word
+        r.op = Op::STOP;
+        break;
+    case 1: case 2: case 3: case 4: case 5: case 6: case 8:
+        if (w.reg < 1 || w.reg > 4) { fault(BAD_REGISTER, w.reg); break; }
+        r.op = (Op)w.opcode;
+        r.reg = &registers_[w.reg];
+        r.cell = cell(address);
+        break;
+    case 7: {                           // BC: LT LE EQ GT GE as flag sets, ANY as a jump
+        static const std::uint8_t kTaken[] = {0, 1, 1 | 2, 2, 4, 4 | 2};
+        if (w.reg < 1 || w.reg > 6) { fault(BAD_CC, w.reg); break; }
+        r.op = w.reg == 6 ? Op::JUMP : Op::BC;
+        r.cc = w.reg == 6 ? 0 : kTaken[w.reg];
+        r.target = recordAt(address);
+        break;
+    }
+    case 9: case 10:
+        r.op = (Op)w.opcode;
+        r.cell = cell(address);
+        break;
+    default:
+        fault(BAD_OPCODE, w.opcode);
+    }
+}
+
+void VirtualMachine::decode(std::vector<Item>& items) {
+    // Zero-filled ranges, merged, for isReserved
+    for (const Item& it : items) {
+        words_ += it.count;
+        if (it.reserve && it.count) reserved_.emplace_back(it.address, it.address + it.count);
+    }
+    std::sort(reserved_.begin(), reserved_.end());
+    std::size_t m = 0;
+    for (std::size_t i = 0; i < reserved_.size(); ++i) {
+        if (m && reserved_[i].first <= reserved_[m - 1].second)
+            reserved_[m - 1].second = std::max(reserved_[m - 1].second, reserved_[i].second);
+        else
+            reserved_[m++] = reserved_[i];
+    }
+    reserved_.resize(m);
+
+    // One item per address: a DS range stands for its first word (a STOP);
+    // a word listed twice (ORIGIN back over code) keeps the later one, and
+    // a word beats a zero-filled range
+    std::stable_sort(items.begin(), items.end(),
+                     [](const Item& a, const Item& b) { return a.address < b.address; });
+    std::size_t k = 0;
+    for (std::size_t i = 0; i < items.size(); ++i) {
+        if (items[i].reserve && items[i].count == 0) continue;
+        if (k && items[k - 1].address == items[i].address) {
+            if (!items[i].reserve) items[k - 1] = items[i];
+            continue;
+        }
+        items[k++] = items[i];
+    }
+    items.resize(k);
+
+    // Records in address order; each break in the addresses gets the record
+    // execution would fall into there
+    std::vector<std::int32_t> itemOf;     // record -> item, -1 for a gap
+    for (std::size_t i = 0; i < items.size(); ++i) {
+        Record r;
+        r.address = items[i].address;
+        code_.push_back(r);
+        itemOf.push_back((std::int32_t)i);
+        const std::uint64_t next = (std::uint64_t)items[i].address + 1;
+        if (next < ADDRESS_END && (i + 1 == items.size() || items[i + 1].address != next)) {
+            Record gap;
+            gap.address = (Address)next;
+            if (!isReserved(gap.address)) {
+                gap.op = Op::FAULT;
+                gap.cc = NO_CODE;
+            }
+            code_.push_back(gap);
+            itemOf.push_back(-1);
+        }
+    }
+    for (std::size_t i = 0; i < code_.size(); ++i) {
+        if (itemOf[i] < 0) continue;
+        const Item& w = items[itemOf[i]];
+        if (w.reserve) continue;                 // a STOP
+        link(code_[i], w);
+        *cell(w.address) = w.instruction ? 0 : w.operand;
+    }
+    start_ = recordAt(entry_);
+}
+
+// ============================================================================
+// EXECUTION
+// ============================================================================
+
+string VirtualMachine::faultMessage(const Record& r) {
+    switch (r.cc) {
+    case NO_CODE:      return "no machine code at this address";
+    case BAD_OPCODE:   return "invalid opcode " + std::to_string(r.detail);
+    case BAD_REGISTER: return "invalid register " + std::to_string(r.detail);
+    default:           return "invalid condition code " + std::to_string(r.detail);
+    }
+}
+
+#ifdef VM_THREADED
+#define VM_CASE(name) op_##name:
+#define VM_DISPATCH() do { ++steps; goto *ip->handler; } while (0)
+#else
+#define VM_CASE(name) case Op::name:
+#define VM_DISPATCH() do { ++steps; goto dispatch; } while (0)
+#endif
+
+VmResult VirtualMachine::run(std::FILE* inFile, std::FILE* outFile, std::uint64_t maxSteps) {
+    VmResult result;
+    if (!start_) {
+        result.stop = VmStop::FAULT;
+        result.message = "no program loaded";
+        return result;
+    }
+#ifdef VM_THREADED
+    static const void* const kHandlers[] = {
+        &&op_STOP, &&op_ADD, &&op_SUB, &&op_MULT, &&op_MOVER, &&op_MOVEM, &&op_COMP,
+        &&op_BC, &&op_DIV, &&op_READ, &&op_PRINT, &&op_JUMP, &&op_FAULT,
+    };
+    if (!threaded_) {
+        for (Record& r : code_) r.handler = kHandlers[(int)r.op];
+        for (Record& r : extra_) r.handler = kHandlers[(int)r.op];
+        threaded_ = true;
+    }
+#endif
+
+    std::fill(registers_, registers_ + 5, 0);
+    VmInput in(inFile);
+    string out;
+    out.reserve(kIoBlock + 16);
+    auto flush = [&] {
+        if (outFile && !out.empty()) std::fwrite(out.data(), 1, out.size(), outFile);
+        out.clear();
+    };
+
+    // The step limit is checked on taken branches: straight-line code always ends
+    const std::uint64_t limit = maxSteps ? maxSteps : UINT64_MAX;
+    std::uint64_t steps = 0;
+    std::uint8_t flags = 0;            // COMP: 1 less, 2 equal, 4 greater
+    std::int32_t value = 0;
+    const Record* ip = start_;
+    const auto t0 = std::chrono::steady_clock::now();
+
+    VM_DISPATCH();
+#ifndef VM_THREADED
+dispatch:
+    switch (ip->op) {
+#endif
+    VM_CASE(STOP)
+        result.stop = VmStop::STOP;
+        goto halt;
+    VM_CASE(ADD)
+        *ip->reg = (std::int32_t)((std::uint32_t)*ip->reg + (std::uint32_t)*ip->cell);
+        ++ip;
+        VM_DISPATCH();
+    VM_CASE(SUB)
+        *ip->reg = (std::int32_t)((std::uint32_t)*ip->reg - (std::uint32_t)*ip->cell);
+        ++ip;
+        VM_DISPATCH();
+    VM_CASE(MULT)
+        *ip->reg = (std::int32_t)((std::uint32_t)*ip->reg * (std::uint32_t)*ip->cell);
+        ++ip;
+        VM_DISPATCH();
+    VM_CASE(MOVER)
+        *ip->reg = *ip->cell;
+        ++ip;
+        VM_DISPATCH();
+    VM_CASE(MOVEM)
+        *ip->cell = *ip->reg;
+        ++ip;
+        VM_DISPATCH();
+    VM_CASE(COMP)
+        flags = *ip->reg < *ip->cell ? 1 : *ip->reg == *ip->cell ? 2 : 4;
+        ++ip;
+        VM_DISPATCH();
+    VM_CASE(BC)
+        if (!(flags & ip->cc)) { ++ip; VM_DISPATCH(); }
+        if (steps >= limit) goto stepLimit;
+        ip = ip->target;
+        VM_DISPATCH();
+    VM_CASE(JUMP)
+        if (steps >= limit) goto stepLimit;
+        ip = ip->target;
+        VM_DISPATCH();
+    VM_CASE(DIV)
+        if (*ip->cell == 0) {
+            result.message = "division by zero";
+            goto fault;
+        }
+        *ip->reg = (*ip->reg == INT_MIN && *ip->cell == -1) ? INT_MIN : *ip->reg / *ip->cell;
+        ++ip;
+        VM_DISPATCH();
+    VM_CASE(READ)
+        if (!in.next(value)) {
+            result.message = "READ found no integer left in the input";
+            goto fault;
+        }
+        *ip->cell = value;
+        ++ip;
+        VM_DISPATCH();
+    VM_CASE(PRINT)
+        appendInt(out, *ip->cell);
+        out += '\n';
+        if (out.size() >= kIoBlock) flush();
+        ++ip;
+        VM_DISPATCH();
+    VM_CASE(FAULT)
+        --steps;                       // not executed
+        result.message = faultMessage(*ip);
+        goto fault;
+#ifndef VM_THREADED
+    }
+#endif
+
+stepLimit:
+    result.stop = VmStop::STEP_LIMIT;
+    goto halt;
+fault:
+    result.stop = VmStop::FAULT;
+halt:
+    result.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+    flush();
+    if (outFile) std::fflush(outFile);
+    result.address = ip->address;
+    result.steps = steps;
+    std::copy(registers_ + 1, registers_ + 5, result.registers);
+    return result;
+}
@@ -0,0 +1,118 @@
+#pragma once
+// vm.hpp — interpreter for the pseudo machine's code (--run)
+//
+// Loads an object file (output.obj) or a text listing (output.txt) and runs it.
+// The machine: four registers AREG..DREG (1..4), a condition flag set by COMP
+// and tested by BC (LT=1 LE=2 EQ=3 GT=4 GE=5 ANY=6), word-addressed memory of
+// 32-bit cells, and the eleven instructions of the MOT:
+//   00 STOP  01 ADD  02 SUB  03 MULT  04 MOVER  05 MOVEM  06 COMP
+//   07 BC    08 DIV  09 READ 10 PRINT
+// Arithmetic wraps at 32 bits. READ takes the next integer of the input,
+// PRINT writes one integer per line. Execution starts at the START address
+// (a listing does not record it, so there: at the first listed word). A word
+// is executed as what it encodes, so running into a constant, a DS word or a
+// literal is a STOP, as on the real machine.
+//
+// Every word is decoded once, at load: the record holds its handler, a pointer
+// to the register and to the memory cell it names, and for BC the record it
+// branches to. Dispatch jumps from record to record (computed goto under GCC
+// and Clang, a switch elsewhere) and never decodes or looks an address up
+// while running. Anything that cannot run (a bad register, an address with
+// no code) decodes to a fault record and only faults if it is reached.
+// Because the decoded program is fixed, a store into an instruction word
+// changes that cell's data but not the instruction; instruction words read
+// as 0.
+#include <cstdint>
+#include <cstdio>
+#include <deque>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "assembler.hpp"
+
+enum class VmStop : std::uint8_t {
+    STOP,          // executed a STOP (or a data word)
+    FAULT,         // see VmResult::message
+    STEP_LIMIT     // ran maxSteps instructions
+};
+
+struct VmResult {
+    VmStop stop = VmStop::STOP;
+    Address address = 0;             // address of the last instruction executed / the fault
+    std::uint64_t steps = 0;         // instructions executed
+    double seconds = 0;              // wall time of the run itself, loading excluded
+    std::string message;             // why it faulted
+    std::int32_t registers[4] = {};  // AREG..DREG at the end
+};
+
+class VirtualMachine {
+public:
+    VirtualMachine() = default;
+    VirtualMachine(const VirtualMachine&) = delete;
+    VirtualMachine& operator=(const VirtualMachine&) = delete;
+
+    // Loads and decodes `path`: an object file if it starts with the object
+    // magic, else a listing. Objects load at `base` when rebase is set.
+    bool load(const std::string& path, std::string& error, bool rebase = false, Address base = 0);
+
+    // Runs the loaded program from its entry point; READ takes integers from
+    // `in`, PRINT writes to `out`, both buffered in large blocks.
+    // maxSteps 0 = no limit. Registers start at 0; memory keeps what an
+    // earlier run stored.
+    VmResult run(std::FILE* in, std::FILE* out, std::uint64_t maxSteps = 0);
+
+    std::size_t wordsLoaded() const { return words_; }
+    Address entry() const { return entry_; }
+
+private:
+    enum class Op : std::uint8_t {
+        STOP, ADD, SUB, MULT, MOVER, MOVEM, COMP, BC, DIV, READ, PRINT,
+        JUMP,      // BC ANY
+        FAULT      // cannot run; Record::cc holds the Fault
+    };
+
+    // One decoded word
+    struct Record {
+        const void* handler = nullptr;   // dispatch target for Op (computed goto builds)
+        std::int32_t* reg = nullptr;
+        std::int32_t* cell = nullptr;    // the memory operand
+        const Record* target = nullptr;  // BC destination
+        Address address = 0;             // where this word is
+        Op op = Op::STOP;
+        std::uint8_t cc = 0;             // BC: flags that take the branch; FAULT: its Fault
+        std::uint16_t detail = 0;        // FAULT: the offending opcode / register / cc
+    };
+
+    enum Fault : std::uint8_t { NO_CODE, BAD_OPCODE, BAD_REGISTER, BAD_CC };
+
+    // A loaded word or a zero-filled (DS) range, before decoding
+    struct Item {
+        Address address;
+        std::uint32_t count;   // words in a reserved range; 1 for a word
+        bool reserve;
+        std::uint8_t opcode, reg;
+        std::int32_t operand;  // address field / constant
+        bool instruction;
+    };
+
+    bool loadObject(const std::string& path, std::string& error, bool rebase, Address base);
+    bool loadListing(const std::string& path, std::string& error);
+    void decode(std::vector<Item>& items);
+    void link(Record& r, const Item& item);
+    bool isReserved(Address a) const;
+    std::int32_t* cell(Address a);
+    const Record* recordAt(Address a);
+    static std::string faultMessage(const Record& r);
+
+    std::vector<Record> code_;                 // decoded words in address order; gaps hold a fault record
+    std::deque<Record> extra_;                 // branch targets inside DS ranges or outside the image
+    std::unordered_map<Address, const Record*> extraAt_;
+    std::vector<std::pair<Address, Address>> reserved_;   // [begin, end) zero-filled ranges, sorted
+    std::unordered_map<Address, std::unique_ptr<std::int32_t[]>> pages_;   // 1024-word pages, made at load
+    std::int32_t registers_[5] = {};           // [0] unused
+    bool threaded_ = false;                    // handlers filled in (computed goto builds)
+    const Record* start_ = nullptr;
+    Address entry_ = 0;
+    std::size_t words_ = 0;
+};
@@ -0,0 +1,139 @@
+// xref.cpp — writer and mmap reader for the cross-reference index (see xref.hpp)
+
+#include "xref.hpp"
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <tuple>
+#include <vector>
+
+using std::string;
+
+const char* referenceKindName(ReferenceKind k) {
+    switch (k) {
+    case ReferenceKind::DEFINITION: return "definition";
+    case ReferenceKind::OPERAND:    return "operand";
+    case ReferenceKind::EXPRESSION: return "expression";
+    }
+    return "?";
+}
+
+template <typename T>
+static void writeArray(std::ofstream& out, const std::vector<T>& v) {
+    if (!v.empty()) out.write(reinterpret_cast<const char*>(v.data()), (std::streamsize)(v.size() * sizeof(T)));
+}
+
+static auto entryKey(const XrefEntry& e) { return std::make_tuple(e.ic, e.line, e.kind); }
+
+// Serializes pass1's references as xref.bin
+bool writeXref(const AssemblerData& data, const string& file) {
+    std::ofstream out(file, std::ios::binary);
+    if (!out.is_open()) {
+        std::cerr << "Error: Cannot create " << file << "\n";
+        return false;
+    }
+
+    // Bucket the references by symbol (counting sort), then order and
+    // deduplicate each symbol's slice, compacting as we go
+    const size_t nsym = data.symbolTable.size();
+    std::vector<std::uint32_t> firstRef(nsym + 1, 0);
+    for (const SymbolReference& r : data.references) ++firstRef[r.symbol + 1];
+    for (size_t id = 0; id < nsym; ++id) firstRef[id + 1] += firstRef[id];
+    std::vector<XrefEntry> refs(data.references.size());
+    std::vector<std::uint32_t> fill(firstRef.begin(), firstRef.end() - 1);
+    for (const SymbolReference& r : data.references)
+        refs[fill[r.symbol]++] = XrefEntry{r.ic, r.line, (std::uint8_t)r.kind, {}};
+    std::uint32_t kept = 0;
+    for (size_t id = 0; id < nsym; ++id) {
+        const std::uint32_t begin = firstRef[id], end = firstRef[id + 1];
+        std::sort(refs.begin() + begin, refs.begin() + end,
+                  [](const XrefEntry& a, const XrefEntry& b) { return entryKey(a) < entryKey(b); });
+        firstRef[id] = kept;
+        for (std::uint32_t k = begin; k < end; ++k)
+            if (kept == firstRef[id] || entryKey(refs[kept - 1]) != entryKey(refs[k])) refs[kept++] = refs[k];
+    }
+    firstRef[nsym] = kept;
+    refs.resize(kept);
+
+    std::vector<Address> symAddr;
+    string strings;
+    std::vector<std::uint32_t> nameOffset;
+    for (std::uint32_t id = 0; id < nsym; ++id) {
+        const SymbolTableEntry& e = data.symbolTable[id];
+        symAddr.push_back(e.defined ? e.address : NO_ADDRESS);
+        nameOffset.push_back((std::uint32_t)strings.size());
+        strings += data.symbolIds.name(id);
+    }
+    nameOffset.push_back((std::uint32_t)strings.size());
+    strings.resize((strings.size() + 3) & ~size_t(3), '\0'); // keep the file 4-byte aligned
+
+    XrefHeader h{};
+    std::memcpy(h.magic, XREF_MAGIC, sizeof h.magic);
+    h.version     = XREF_VERSION;
+    h.entrySize   = sizeof(XrefEntry);
+    h.symbolCount = (std::uint32_t)nsym;
+    h.refCount    = kept;
+    h.stringBytes = (std::uint32_t)strings.size();
+
+    out.write(reinterpret_cast<const char*>(&h), sizeof h);
+    writeArray(out, symbolsByName(data));
+    writeArray(out, symAddr);
+    writeArray(out, nameOffset);
+    writeArray(out, firstRef);
+    writeArray(out, refs);
+    out.write(strings.data(), (std::streamsize)strings.size());
+    return (bool)out;
+}
+
+// True if `count + 1` offsets never decrease and end at or before `limit`
+static bool offsetsValid(const std::uint32_t* offset, std::uint32_t count, std::uint32_t limit) {
+    for (std::uint32_t i = 0; i < count; ++i)
+        if (offset[i] > offset[i + 1]) return false;
+    return offset[count] <= limit;
+}
+
+bool XrefFile::open(const string& path, string& error) {
+    if (!file_.open(path)) { error = "Cannot open " + path; return false; }
+    if (file_.size() < sizeof(XrefHeader)) { error = path + ": truncated header"; return false; }
+
+    hdr_ = reinterpret_cast<const XrefHeader*>(file_.data());
+    if (std::memcmp(hdr_->magic, XREF_MAGIC, sizeof hdr_->magic) != 0) { error = path + ": not a cross-reference index"; return false; }
+    if (hdr_->version != XREF_VERSION || hdr_->entrySize != sizeof(XrefEntry)) {
+        error = path + ": unsupported cross-reference index version";
+        return false;
+    }
+
+    const std::uint64_t need = sizeof(XrefHeader)
+        + (std::uint64_t)hdr_->symbolCount * 16 + 8
+        + (std::uint64_t)hdr_->refCount * sizeof(XrefEntry)
+        + hdr_->stringBytes;
+    if (file_.size() < need) { error = path + ": truncated file"; return false; }
+
+    const char* p = file_.data() + sizeof(XrefHeader);
+    auto take = [&p](size_t bytes) { const char* q = p; p += bytes; return q; };
+    byName_     = reinterpret_cast<const std::uint32_t*>(take(hdr_->symbolCount * 4));
+    symAddr_    = reinterpret_cast<const Address*>(take(hdr_->symbolCount * 4));
+    nameOffset_ = reinterpret_cast<const std::uint32_t*>(take((hdr_->symbolCount + 1) * 4));
+    firstRef_   = reinterpret_cast<const std::uint32_t*>(take((hdr_->symbolCount + 1) * 4));
+    refs_       = reinterpret_cast<const XrefEntry*>(take(hdr_->refCount * sizeof(XrefEntry)));
+    strings_    = take(hdr_->stringBytes);
+    if (!offsetsValid(nameOffset_, hdr_->symbolCount, hdr_->stringBytes) ||
+        !offsetsValid(firstRef_, hdr_->symbolCount, hdr_->refCount) ||
+        std::any_of(byName_, byName_ + hdr_->symbolCount, [this](std::uint32_t id) { return id >= hdr_->symbolCount; })) {
+        error = path + ": inconsistent tables";
+        return false;
+    }
+    return true;
+}
+
+std::string_view XrefFile::symbolName(std::uint32_t id) const {
+    return std::string_view(strings_ + nameOffset_[id], nameOffset_[id + 1] - nameOffset_[id]);
+}
+
+std::int64_t XrefFile::find(std::string_view name) const {
+    const std::uint32_t* end = byName_ + hdr_->symbolCount;
+    const std::uint32_t* it = std::lower_bound(byName_, end, name,
+        [this](std::uint32_t id, std::string_view n) { return symbolName(id) < n; });
+    return it != end && symbolName(*it) == name ? (std::int64_t)*it : -1;
+}
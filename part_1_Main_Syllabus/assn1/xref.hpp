@@ -0,0 +1,75 @@
+#pragma once
+// xref.hpp — cross-reference index of Pass 1 (xref.bin, --emit-xref)
+//
+// Every definition and use of every symbol, grouped by symbol: "who
+// references X" is a binary search over the names and one contiguous slice
+// of the mapped file, with no reassembly.
+//
+// Layout (little-endian, 4-byte aligned, written in this order):
+//   XrefHeader
+//   uint32    byName[symbolCount]          symbol IDs in name order
+//   uint32    symbolAddress[symbolCount]   indexed by symbol ID; 0xFFFFFFFF = undefined
+//   uint32    nameOffset[symbolCount + 1]  into the string pool
+//   uint32    firstRef[symbolCount + 1]    symbol `id`'s references are
+//                                          refs[firstRef[id], firstRef[id + 1])
+//   XrefEntry refs[refCount]               by symbol, then IC index, line, kind
+//   char      strings[stringBytes]
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include "assembler.hpp"
+#include "../../common/mapped_file.hpp"
+
+constexpr char          XREF_MAGIC[8] = {'A','S','M','X','R','E','F','\0'};
+constexpr std::uint32_t XREF_VERSION  = 1;
+
+struct XrefHeader {
+    char          magic[8];
+    std::uint32_t version;
+    std::uint32_t entrySize;       // sizeof(XrefEntry)
+    std::uint32_t symbolCount;
+    std::uint32_t refCount;
+    std::uint32_t stringBytes;
+    std::uint32_t reserved;
+};
+static_assert(sizeof(XrefHeader) == 32, "xref header layout");
+
+// One SymbolReference, less the symbol (implied by the slice it is in)
+struct XrefEntry {
+    std::uint32_t ic;              // IC record index
+    std::int32_t  line;
+    std::uint8_t  kind;            // ReferenceKind
+    std::uint8_t  pad[3];
+};
+static_assert(sizeof(XrefEntry) == 12, "xref entry layout");
+
+const char* referenceKindName(ReferenceKind k);
+
+// Writes data.references (pass 1 run with data.crossReference set) as an index;
+// repeated references (a symbol twice in one expression) are stored once
+bool writeXref(const AssemblerData& data, const std::string& file);
+
+// Read-only view over a mapped xref.bin; all pointers point into the mapping.
+class XrefFile {
+public:
+    bool open(const std::string& path, std::string& error);
+
+    const XrefHeader& header() const { return *hdr_; }
+    std::string_view  symbolName(std::uint32_t id) const;
+    Address           symbolAddress(std::uint32_t id) const { return symAddr_[id]; }
+    const XrefEntry*  refsBegin(std::uint32_t id) const { return refs_ + firstRef_[id]; }
+    const XrefEntry*  refsEnd(std::uint32_t id) const { return refs_ + firstRef_[id + 1]; }
+
+    // ID of the symbol named `name` (O(log n) over byName), or -1
+    std::int64_t find(std::string_view name) const;
+
+private:
+    MappedFile file_;
+    const XrefHeader*    hdr_ = nullptr;
+    const std::uint32_t* byName_ = nullptr;
+    const Address*       symAddr_ = nullptr;
+    const std::uint32_t* nameOffset_ = nullptr;
+    const std::uint32_t* firstRef_ = nullptr;
+    const XrefEntry*     refs_ = nullptr;
+    const char*          strings_ = nullptr;
+};
@@ -7,9 +7,8 @@ int main(int argc, char** argv){
     cin.tie(nullptr);
 
     if (argc != 2){
-        cerr << "Usage: " << argv[0] << " <source.asm>\n";
+        cerr << "Usage: " << argv[0] << " <source.asm | ->\n";
         return 1;
     }
-    init_tables();
     return run_pass1(argv[1]);
 }
@@ -1,4 +1,5 @@
 #include "pass1.hpp"
+#include "../../common/line_reader.hpp"
 #include <fstream>
 #include <iomanip>
 #include <map>
@@ -6,16 +7,19 @@
 using namespace std;
 
 int run_pass1(const string& sourcePath){
-    ifstream in(sourcePath);
-    if (!in){ cerr<<"Cannot open "<<sourcePath<<"\n"; return 1; }
+    // mmap for regular files, block reads for pipes / "-" (stdin)
+    LineReader in;
+    if (!in.open(sourcePath)){ cerr<<"Cannot open "<<sourcePath<<"\n"; return 1; }
 
-    map<string, Sym> ST;
+    SymTab ST;
     vector<Lit> LT;
     vector<int> PT;        // pool starts (indices into LT)
     vector<ICLine> IC;
     int LC = 0;
 
-    auto start_new_pool = [&](){ PT.push_back((int)LT.size()); };
+    SymbolInterner poolLits;   // literal text -> ordinal within the current pool (LT index = PT.back() + ordinal)
+
+    auto start_new_pool = [&](){ PT.push_back((int)LT.size()); poolLits.clear(); };
 
     auto assign_pool_literals = [&](){
         if (PT.empty()) return;
@@ -28,137 +32,217 @@ int run_pass1(const string& sourcePath){
         }
     };
 
-    string raw;
-    while (getline(in, raw)){
-        string line = trim(raw);
-        if (line.empty() || line.rfind("#",0)==0 || line.rfind("//",0)==0) continue;
+    // EQUs on forward references wait here with their compiled expressions and
+    // are resolved when first needed or after END, in dependency order
+    asmexpr::DeferredList deferred;
+    vector<size_t> deferredIC;     // their IC records, whose (C,value) is filled in then
+
+    auto known = [&](uint32_t id, int64_t& v){ v = ST[id].address; return ST[id].address != -1; };
+    auto settle = [&](int i, const asmexpr::Result& r){
+        const asmexpr::DeferredList::Entry& q = deferred[i];
+        ST[q.symbol].equ = -1;
+        if (r.status==asmexpr::Status::OK && r.value>=INT_MIN && r.value<=INT_MAX){
+            ST[q.symbol].address = (int)r.value;
+            IC[deferredIC[i]].c.value = (int)r.value;
+            return;
+        }
+        cerr<<"Line "<<q.line<<": EQU "<<ST.name(q.symbol)<<" ";
+        if (r.status==asmexpr::Status::OK) cerr<<"value "<<r.value<<" is out of range\n";
+        else if (r.status==asmexpr::Status::UNDEFINED && ST[r.symbol].equ>=0) cerr<<"is circular through "<<ST.name(r.symbol)<<"\n";
+        else cerr<<asmexpr::describe(r, [&](uint32_t id){ return ST.name(id); })<<"\n";
+    };
+    auto resolve = [&](int i, bool final){
+        asmexpr::resolve(deferred, i, final, known, [&](uint32_t id){ return ST[id].equ; }, settle);
+    };
+    // symbol values for directive operands; a deferred EQU is resolved on first use
+    auto value = [&](uint32_t id, int64_t& v){
+        if (ST[id].address==-1 && ST[id].equ>=0) resolve(ST[id].equ, false);
+        return known(id, v);
+    };
+    auto name = [&](uint32_t id){ return ST.name(id); };
+    // evaluates a directive operand into r; false (why set) if it is not an expression
+    auto evaluate = [&](string_view text, asmexpr::Expr& e, asmexpr::Result& r, string& why){
+        if (asmexpr::parseInteger(text, r.value)) return true;
+        if (!compile_expr(text, ST, e, why)) return false;
+        r = asmexpr::evaluate(e, value);
+        return true;
+    };
+    // an operand needed on its own line (START/ORIGIN/DS)
+    auto eval = [&](string_view text, int& out, string& why){
+        asmexpr::Expr e;
+        asmexpr::Result r;
+        if (!evaluate(text, e, r, why)) return false;
+        if (r.status!=asmexpr::Status::OK){ why = asmexpr::describe(r, name); return false; }
+        if (r.value<INT_MIN || r.value>INT_MAX){ why = "out of range"; return false; }
+        out = (int)r.value;
+        return true;
+    };
+
+    string_view raw;
+    asmscan::LineBits bits;
+    while (in.next(raw, bits)){
+        // blanks and commas come from the line's class bits (byte loops past 64 bytes)
+        asmscan::MaskedText text{raw, bits.space, bits.comma};
+        if (bits.valid) text = asmscan::trim(text);
+        string_view line = bits.valid ? text.text : asmlex::trim(raw);
+        if (line.empty() || line[0]=='#' || line.substr(0,2)=="//") continue;
 
-        vector<string> tok = split_ws_commas(line);
-        string label, mnem; size_t idx = 0;
+        // tokens are views into the source: label, mnemonic and up to 6 operands
+        string_view tok[8];
+        const int ntok = bits.valid ? asmscan::tokenize(text, tok, 8, true) : asmlex::tokenize(line, tok, 8, true);
+        string_view label, mnem; int idx = 0;
 
         // label?
-        if (idx<tok.size() && MOT().count(tok[idx])==0 && tok[idx]!="LTORG" && tok[idx]!="END"){
+        if (idx<ntok && !find_mot(tok[idx]) && tok[idx]!="LTORG" && tok[idx]!="END"){
             label = tok[idx++];
         }
-        if (idx<tok.size()) mnem = tok[idx++];
+        if (idx<ntok) mnem = tok[idx++];
 
-        if (!label.empty()){
-            auto &sym = ST[label];
-            sym.name = label;
-            if (sym.address==-1 || sym.address==0) sym.address = LC;
+        int labelId = label.empty()? -1 : ST.id(label);
+        if (labelId>=0 && mnem!="EQU"){     // an EQU label gets its value below
+            auto &sym = ST[labelId];
+            if (sym.equ<0 && (sym.address==-1 || sym.address==0)) sym.address = LC;
         }
         if (mnem.empty()) continue;
 
-        if (MOT().count(mnem)==0){
-            cerr<<"Unknown mnemonic: "<<mnem<<"\n";
+        const Instr* ins = find_mot(mnem);
+        if (!ins){
+            cerr<<"Line "<<in.lineNumber()<<": Unknown mnemonic: "<<mnem<<"\n";
             continue;
         }
-        Instr I = MOT().at(mnem);
+        const Instr I = *ins;
 
-        vector<string> ops;
-        while (idx<tok.size()) ops.push_back(tok[idx++]);
+        const string_view* ops = tok + idx;
+        const int nops = ntok - idx;
 
         if (I.type==IType::AD){
             if (mnem=="START"){
-                int start = (ops.size()? stoi(ops[0]) : 0);
+                int start = 0; string why;
+                if (nops && !eval(ops[0], start, why)){
+                    cerr<<"Line "<<in.lineNumber()<<": Invalid START address "<<ops[0]<<" ("<<why<<")\n";
+                    start = 0;
+                }
                 LC = start;
-                IC.push_back({-1,"(AD,01)","(C,"+to_string(start)+")",""});
+                IC.push_back({-1,"AD",1,{"C",start},{}});
                 start_new_pool();
             } else if (mnem=="END"){
                 assign_pool_literals();
-                IC.push_back({-1,"(AD,02)","",""});
+                IC.push_back({-1,"AD",2,{},{}});
                 break;
             } else if (mnem=="LTORG"){
                 assign_pool_literals();
-                IC.push_back({-1,"(AD,05)","",""});
+                IC.push_back({-1,"AD",5,{},{}});
                 start_new_pool();
             } else if (mnem=="ORIGIN"){
-                string expr = (ops.empty()? "0" : ops[0]);
-                int val = eval_expr(expr, ST);
-                LC = val;
-                IC.push_back({-1,"(AD,03)","(C,"+to_string(val)+")",""});
+                int val = 0; string why;
+                if (eval(nops? ops[0] : string_view("0"), val, why)) LC = val;
+                else cerr<<"Line "<<in.lineNumber()<<": Invalid ORIGIN expression "<<ops[0]<<" ("<<why<<")\n";
+                IC.push_back({-1,"AD",3,{"C",LC},{}});
             } else if (mnem=="EQU"){
                 if (label.empty()){
-                    cerr<<"EQU without label\n";
+                    cerr<<"Line "<<in.lineNumber()<<": EQU without label\n";
+                } else if (ST[labelId].equ>=0){
+                    cerr<<"Line "<<in.lineNumber()<<": EQU "<<label<<" is already waiting on another EQU\n";
                 } else {
-                    int val = eval_expr(ops[0], ST);
-                    ST[label].address = val;
-                    IC.push_back({-1,"(AD,04)","(S,"+label+")","(C,"+to_string(val)+")"});
+                    asmexpr::Expr e;
+                    asmexpr::Result r;     // no operand: 0
+                    string why;
+                    if (nops && evaluate(ops[0], e, r, why) && r.status==asmexpr::Status::UNDEFINED){
+                        // forward reference: defined once the symbols it uses are (see settle)
+                        ST[labelId].address = -1;
+                        ST[labelId].equ = deferred.add((uint32_t)labelId, (int32_t)in.lineNumber(), e);
+                        deferredIC.push_back(IC.size());
+                        IC.push_back({-1,"AD",4,{"S",labelId},{"C",0}});
+                    } else if (why.empty() && r.status==asmexpr::Status::OK && r.value>=INT_MIN && r.value<=INT_MAX){
+                        ST[labelId].address = (int)r.value;
+                        IC.push_back({-1,"AD",4,{"S",labelId},{"C",(int)r.value}});
+                    } else {
+                        if (why.empty()) why = r.status==asmexpr::Status::OK? "out of range" : asmexpr::describe(r, name);
+                        cerr<<"Line "<<in.lineNumber()<<": Invalid EQU expression "<<ops[0]<<" ("<<why<<")\n";
+                        ST[labelId].address = -1;
+                    }
                 }
             }
         }
         else if (I.type==IType::DL){
             if (mnem=="DS"){
-                int size = stoi(ops[0]);
-                if (!label.empty()){ ST[label].address = LC; ST[label].length = size; }
-                IC.push_back({LC,"(DL,01)","(C,"+to_string(size)+")",""});
+                int size = 0; string why;
+                if (nops && !eval(ops[0], size, why)){
+                    cerr<<"Line "<<in.lineNumber()<<": Invalid DS size "<<ops[0]<<" ("<<why<<")\n";
+                    size = 0;
+                }
+                if (labelId>=0){ ST[labelId].address = LC; ST[labelId].length = size; }
+                IC.push_back({LC,"DL",1,{"C",size},{}});
                 LC += size;
             } else if (mnem=="DC"){
-                int val = stoi(ops[0]);
-                if (!label.empty()) ST[label].address = LC;
-                IC.push_back({LC,"(DL,02)","(C,"+to_string(val)+")",""});
+                int val = nops? to_int(ops[0]) : 0;
+                if (labelId>=0) ST[labelId].address = LC;
+                IC.push_back({LC,"DL",2,{"C",val},{}});
                 LC += 1;
             }
         }
         else { // IType::IS
-            ICLine ic; ic.lc = LC;
-            ic.a = "(IS," + (I.opcode<10? string("0")+to_string(I.opcode): to_string(I.opcode)) + ")";
+            ICLine ic{LC,"IS",I.opcode,{},{}};
 
             // operand 1 (reg/cc/sym/const)
-            if (!ops.empty()){
-                if (REG().count(ops[0])) ic.b = "(R,"+to_string(REG().at(ops[0]))+")";
-                else if (CC().count(ops[0])) ic.b = "(CC,"+to_string(CC().at(ops[0]))+")";
+            if (nops>=1){
+                if (const int* r = find_reg(ops[0])) ic.b = {"R",*r};
+                else if (const int* c = find_cc(ops[0])) ic.b = {"CC",*c};
                 else if (!is_literal(ops[0]) && !is_number(ops[0])) {
-                    ST[ops[0]].name = ops[0];
-                    ic.b = "(S,"+ops[0]+")";
+                    ic.b = {"S",ST.id(ops[0])};
                 } else if (is_number(ops[0])) {
-                    ic.b = "(C,"+ops[0]+")";
+                    ic.b = {"C",to_int(ops[0])};
                 }
             }
             // operand 2 (sym/lit/const)
-            if (ops.size()>=2){
-                string op2 = ops[1];
+            if (nops>=2){
+                string_view op2 = ops[1];
                 if (is_literal(op2)){
-                    int val = literal_value_of(op2);
-                    int idxLit = -1;
-                    for (int i=0;i<(int)LT.size();++i) if (LT[i].literal==op2){ idxLit=i; break; }
-                    if (idxLit==-1){
-                        LT.push_back({op2,val,-1});
-                        if (PT.empty()) start_new_pool();
-                    }
-                    ic.c = "(L," + to_string(idxLit==-1? (int)LT.size()-1 : idxLit) + ")";
+                    if (PT.empty()) start_new_pool();
+                    int idxLit = PT.back() + (int)poolLits.intern(op2);
+                    if (idxLit == (int)LT.size())
+                        LT.push_back({string(op2),literal_value_of(op2),-1});
+                    ic.c = {"L", idxLit};
                 } else if (is_number(op2)) {
-                    ic.c = "(C,"+op2+")";
+                    ic.c = {"C",to_int(op2)};
                 } else {
-                    ST[op2].name = op2;
-                    ic.c = "(S,"+op2+")";
+                    ic.c = {"S",ST.id(op2)};
                 }
             }
             IC.push_back(ic);
             LC += I.length;
         }
     }
-    in.close();
+
+    // END: EQUs still waiting on forward references, in dependency order
+    for (size_t i=0; i<deferred.size(); ++i)
+        if (ST[deferred[i].symbol].equ==(int)i) resolve((int)i, true);
 
     // --------- Outputs ----------
     {
+        // symbol operands are carried as IDs and only turned back into names here
+        auto tuple = [&](const char* kind, int value){
+            return string("(") + kind + "," + (strcmp(kind,"S")==0? string(ST.name(value)) : to_string(value)) + ")";
+        };
         ofstream f("intermediate.txt");
         for (auto &x: IC){
-            if (x.lc>=0) f << setw(4) << setfill('0') << x.lc << "  ";
+            if (x.lc>=0) f << right << setw(4) << setfill('0') << x.lc << setfill(' ') << "  ";
             else f << "     ";
-            f << left << setw(10) << x.a;
-            if (!x.b.empty()) f << " " << left << setw(10) << x.b;
-            if (!x.c.empty()) f << " " << left << setw(10) << x.c;
+            char head[16];
+            snprintf(head, sizeof head, "(%s,%02d)", x.cls, x.opcode);
+            f << left << setw(10) << head;
+            if (x.b.kind) f << " " << left << setw(10) << tuple(x.b.kind, x.b.value);
+            if (x.c.kind) f << " " << left << setw(10) << tuple(x.c.kind, x.c.value);
             f << "\n";
         }
     }
     {
         ofstream f("symbol_table.txt");
         f << left << setw(16) << "SYMBOL" << setw(8) << "ADDR" << setw(8) << "LEN" << "\n";
-        for (auto &kv: ST){
-            f << left << setw(16) << kv.second.name
-              << setw(8) << kv.second.address
-              << setw(8) << kv.second.length << "\n";
+        for (int id: ST.by_name()){
+            f << left << setw(16) << ST.name(id)
+              << setw(8) << ST[id].address
+              << setw(8) << ST[id].length << "\n";
         }
     }
     {
@@ -4,8 +4,12 @@
 #include <cctype>
 #include<bits/stdc++.h>
 #include <string>
+#include <string_view>
 #include <unordered_map>
 #include <vector>
+#include "../../common/symbol_interner.hpp"
+#include "../../common/asm_lexer.hpp"
+#include "../../common/expr.hpp"
 
 // ------------------ Core types ------------------
 enum class IType { IS, DL, AD };
@@ -17,9 +21,28 @@ struct Instr {
 };
 
 struct Sym {
-    std::string name;
     int address = -1;
     int length = 1;
+    int equ = -1;       // index of its deferred EQU while that waits on a forward reference
+};
+
+// Symbol table: names are interned to dense IDs, entries live in an ID-indexed vector
+struct SymTab {
+    SymbolInterner ids;
+    std::vector<Sym> syms;
+
+    int id(std::string_view name){             // interns, creating the entry
+        std::uint32_t i = ids.intern(name);
+        if (i == syms.size()) syms.push_back(Sym{});
+        return (int)i;
+    }
+    const Sym* find(std::string_view name) const {
+        std::uint32_t i = ids.find(name);
+        return i == SymbolInterner::npos ? nullptr : &syms[i];
+    }
+    Sym& operator[](int i){ return syms[i]; }
+    std::string_view name(int i) const { return ids.name((std::uint32_t)i); }
+    std::vector<int> by_name() const;          // IDs sorted by name (for output)
 };
 
 struct Lit {
@@ -28,27 +51,34 @@ struct Lit {
     int address = -1;
 };
 
+// IC operand: kind is "R", "CC", "C", "S" or "L" (nullptr = absent); S carries a symbol ID
+struct ICOperand {
+    const char* kind = nullptr;
+    int value = 0;
+};
+
 struct ICLine {
-    int lc;            // location counter at this line (-1 for pseudo)
-    std::string a, b, c; // e.g. (IS,04) (R,1) (S,VALUE)
+    int lc;             // location counter at this line (-1 for pseudo)
+    const char* cls;    // "IS" / "DL" / "AD"
+    int opcode;
+    ICOperand b, c;     // e.g. (IS,04) (R,1) (S,VALUE)
 };
 
 // ------------------ Tables API ------------------
-// Must be called once before run_pass1
-void init_tables();
-
-// Read-only accessors for MOT/REG/CC
-const std::unordered_map<std::string, Instr>& MOT();
-const std::unordered_map<std::string, int>&   REG();
-const std::unordered_map<std::string, int>&   CC();
+// Compile-time MOT/REG/CC lookups (exact match); nullptr if the token is not in the table
+const Instr* find_mot(std::string_view k);
+const int*   find_reg(std::string_view k);
+const int*   find_cc(std::string_view k);
 
 // ------------------ Utilities (used by pass1.cpp) ------------------
-std::string trim(const std::string& s);
-std::vector<std::string> split_ws_commas(const std::string& line);
-bool is_number(const std::string& s);
-bool is_literal(const std::string& s);
-int  literal_value_of(const std::string& lit);
-int  eval_expr(const std::string& expr, const std::map<std::string, Sym>& ST);
+// Line splitting/trimming comes from common/asm_lexer.hpp (string_view tokens).
+bool is_number(std::string_view s);
+bool is_literal(std::string_view s);
+int  to_int(std::string_view s);           // 0 if not a number
+int  literal_value_of(std::string_view lit);
+// START/ORIGIN/EQU/DS operand: SYMBOL, K, and + - * / ( ) over them (common/expr.hpp).
+// Symbols are interned into ST, forward references included.
+bool compile_expr(std::string_view expr, SymTab& ST, asmexpr::Expr& out, std::string& why);
 
 // ------------------ Pass-I driver ------------------
 int run_pass1(const std::string& sourcePath);
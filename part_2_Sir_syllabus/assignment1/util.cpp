@@ -3,60 +3,41 @@
 #include<bits/stdc++.h>
 using namespace std;
 
-string trim(const string& s){
-    size_t i = s.find_first_not_of(" \t\r\n");
-    if (i==string::npos) return "";
-    size_t j = s.find_last_not_of(" \t\r\n");
-    return s.substr(i, j-i+1);
-}
-
-vector<string> split_ws_commas(const string& line){
-    vector<string> out; string tok;
-    for(char c: line){
-        if (c==',' || isspace((unsigned char)c)){
-            if (!tok.empty()){ out.push_back(tok); tok.clear(); }
-        } else tok.push_back(c);
-    }
-    if (!tok.empty()) out.push_back(tok);
-    return out;
-}
-
-bool is_number(const string& s){
+bool is_number(string_view s){
     if(s.empty()) return false;
     size_t i=0; if(s[0]=='+'||s[0]=='-') i=1;
     for(; i<s.size(); ++i) if(!isdigit((unsigned char)s[i])) return false;
     return true;
 }
 
-bool is_literal(const string& s){
+bool is_literal(string_view s){
     return s.size()>=2 && s[0]=='=';
 }
 
-int literal_value_of(const string& lit){
+int to_int(string_view s){
+    if (!s.empty() && s[0]=='+') s.remove_prefix(1);   // from_chars takes '-' but not '+'
+    int v = 0;
+    auto r = from_chars(s.data(), s.data()+s.size(), v);
+    return r.ec==errc()? v : 0;
+}
+
+int literal_value_of(string_view lit){
     if (lit.size()<2) return 0;
-    string v = lit.substr(1);
+    string_view v = lit.substr(1);
     if (v.size()>=2 && ((v.front()=='\'' && v.back()=='\'') || (v.front()=='"' && v.back()=='"')))
         v = v.substr(1, v.size()-2);
-    if (is_number(v)) return stoi(v);
+    if (is_number(v)) return to_int(v);
     if (v.size()==1) return (int)(unsigned char)v[0];
     return 0;
 }
 
-// Evaluate SYMBOL / SYMBOL±K / K (K numeric)
-int eval_expr(const string& expr, const map<string, Sym>& ST){
-    auto posp = expr.find('+');
-    auto posm = expr.find('-');
-    if (posp==string::npos && posm==string::npos){
-        if (is_number(expr)) return stoi(expr);
-        auto it=ST.find(expr);
-        if (it!=ST.end() && it->second.address!=-1) return it->second.address;
-        return 0;
-    }
-    auto parseTerm = [&](const string& t)->int{
-        if (is_number(t)) return stoi(t);
-        auto it=ST.find(t);
-        return (it!=ST.end()? it->second.address : 0);
-    };
-    if (posp!=string::npos) return parseTerm(expr.substr(0,posp)) + parseTerm(expr.substr(posp+1));
-    return parseTerm(expr.substr(0,posm)) - parseTerm(expr.substr(posm+1));
+vector<int> SymTab::by_name() const {
+    vector<int> order(syms.size());
+    iota(order.begin(), order.end(), 0);
+    sort(order.begin(), order.end(), [this](int a, int b){ return name(a) < name(b); });
+    return order;
+}
+
+bool compile_expr(string_view expr, SymTab& ST, asmexpr::Expr& out, string& why){
+    return asmexpr::compile(expr, [&ST](string_view name){ return (uint32_t)ST.id(name); }, out, why);
 }
@@ -1,4 +1,10 @@
 #include <bits/stdc++.h>
+#include "../../common/symbol_interner.hpp"
+#include "../../common/asm_lexer.hpp"
+#include "../../common/line_reader.hpp"
+#include "../../common/mapped_file.hpp"
+#include "../../common/format_int.hpp"
+#include "../../common/thread_pool.hpp"
 using namespace std;
 
 /*
@@ -21,21 +27,33 @@ using namespace std;
           0100  +04 1 0108
           0101  +00 0 0000   (for DS words)
           0105  +00 0 0010   (for DC 10)
+        With --collapse-ds a DS is one zero-fill range record instead:
+          0101  +00 0 0000 x1000   (DS 1000: 1000 zero words from 0101)
+
+  USAGE:
+    ./pass2 [--threads N] [--collapse-ds]     (N = 0 means one thread per core)
+    With N > 1 the intermediate file is cut into line-aligned chunks that are
+    translated in parallel and written back in order; output is identical.
 
   NOTES:
     - (IS,xx) => opcode = xx
       operand1 may be (R,k) or (CC,k) → goes to the “reg” field
       operand2 may be (S,name) or (L,i) or (C,val) → address/immediate field
-    - (DL,01) DS n → emit n lines of +00 0 0000
+    - (DL,01) DS n → emit n lines of +00 0 0000 (or one "xn" range record)
     - (DL,02) DC c → emit +00 0 c
     - (AD,**) lines are ignored here (they were already resolved in Pass-I)
 */
 
 struct Sym {
-    string name;
     int addr = -1;
     int len  = 1;
 };
+
+// Symbol table keyed by interned ID: one hash probe per name, then an array index
+struct SymTab {
+    SymbolInterner ids;
+    vector<Sym> syms;   // by ID
+};
 struct Lit {
     string lit;
     int val = 0;
@@ -43,65 +61,179 @@ struct Lit {
 };
 
 // ---------- helpers ----------
-static string trim(const string& s){
-    size_t i = s.find_first_not_of(" \t\r\n");
-    if (i==string::npos) return "";
-    size_t j = s.find_last_not_of(" \t\r\n");
-    return s.substr(i, j-i+1);
-}
-static bool is_digits(const string& s){
+static bool is_digits(string_view s){
     if (s.empty()) return false;
     size_t i=0; if (s[0]=='+'||s[0]=='-') i=1;
     for (; i<s.size(); ++i) if (!isdigit((unsigned char)s[i])) return false;
     return true;
 }
 
+// stoi() for tokens already checked with is_digits(); 0 if it does not parse
+static int to_int(string_view s){
+    int v = 0;
+    return asmlex::parseInt(s, v) == errc() ? v : 0;
+}
+
 // Parse a tuple like "(IS,04)" -> {"IS","04"}
-static bool parse_tuple(const string& tok, string& kind, string& val){
+static bool parse_tuple(string_view tok, string_view& kind, string_view& val){
     if (tok.size()<5 || tok.front()!='(' || tok.back()!=')') return false;
     auto comma = tok.find(',');
-    if (comma==string::npos) return false;
+    if (comma==string_view::npos) return false;
     kind = tok.substr(1, comma-1);
     val  = tok.substr(comma+1, tok.size()-comma-2);
     return true;
 }
 
-// Read Symbol Table
-static map<string, Sym> load_symbols(const string& file){
-    ifstream in(file);
-    map<string, Sym> ST;
-    if (!in) return ST;
-    string line; getline(in,line); // header
-    while (getline(in,line)){
-        line = trim(line); if (line.empty()) continue;
-        istringstream iss(line);
+// Read Symbol Table (mapped, one row per line, numbers via from_chars)
+static SymTab load_symbols(const string& file){
+    LineReader in;
+    SymTab ST;
+    if (!in.open(file)) return ST;
+    string_view line, f[3];
+    in.next(line); // header
+    while (in.next(line)){
+        if (asmlex::tokenize(line, f, 3, false) < 3) continue;
         Sym s;
-        if (!(iss >> s.name >> s.addr >> s.len)) continue;
-        ST[s.name] = s;
+        if (asmlex::parseInt(f[1], s.addr) != errc() || asmlex::parseInt(f[2], s.len) != errc()) continue;
+        uint32_t id = ST.ids.intern(f[0]);
+        if (id == ST.syms.size()) ST.syms.push_back(s);
+        else ST.syms[id] = s;
     }
     return ST;
 }
 
 // Read Literal Table
 static vector<Lit> load_literals(const string& file){
-    ifstream in(file);
+    LineReader in;
     vector<Lit> LT;
-    if (!in) return LT;
-    string line; getline(in,line); // header
-    while (getline(in,line)){
-        line = trim(line); if (line.empty()) continue;
-        istringstream iss(line);
+    if (!in.open(file)) return LT;
+    string_view line, f[3];
+    in.next(line); // header
+    while (in.next(line)){
+        if (asmlex::tokenize(line, f, 3, false) < 3) continue;
         Lit L;
-        if (!(iss >> L.lit >> L.val >> L.addr)) continue;
-        LT.push_back(L);
+        if (asmlex::parseInt(f[1], L.val) != errc() || asmlex::parseInt(f[2], L.addr) != errc()) continue;
+        L.lit = string(f[0]);
+        LT.push_back(std::move(L));
     }
     return LT;
 }
 
+// Translates one intermediate line into machine code appended to `out`.
+// Reads the tables only, so chunks of lines can be translated concurrently.
+static void translate_line(string_view line, const SymTab& ST, const vector<Lit>& LT,
+                           bool collapse_ds, string& out){
+    string_view s = asmlex::trim(line);
+    if (s.empty()) return;
+
+    // Tokenize: first field may be LC or blank; then tuples
+    string_view first = asmlex::nextToken(s, false);
+
+    int lc = -1;
+    string_view head;
+
+    if (!first.empty() && is_digits(first)) {
+        lc = to_int(first);
+        head = asmlex::nextToken(s, false);
+    } else {
+        // first wasn't LC; it's a tuple
+        head = first;
+    }
+
+    // Parse first tuple to know what this line is
+    if (head.empty()) return;
+    string_view k0, v0;
+    if (!parse_tuple(head, k0, v0)) return;
+
+    // Handle AD (assembler directives) -> no machine code
+    if (k0 == "AD") return;
+
+    // Handle DL (declaratives)
+    if (k0 == "DL") {
+        string_view k1, v1, t1 = asmlex::nextToken(s, false);
+        bool haveC = !t1.empty() && parse_tuple(t1, k1, v1) && k1=="C" && is_digits(v1);
+        if (v0 == "01") { // DS
+            // Expect (C,n) as next tuple
+            int n = haveC ? to_int(v1) : 0;
+            if (collapse_ds){
+                // one range record; readers expand it to n zero words when they need them
+                appendInt(out, lc, 4);
+                out += "  +00 0 0000 x";
+                appendInt(out, max(n, 0));
+                out += '\n';
+                return;
+            }
+            for (int i=0;i<n;i++){
+                appendInt(out, (long long)lc+i, 4);
+                out += "  +00 0 0000\n";
+            }
+        } else if (v0 == "02") { // DC
+            // Expect (C,val)
+            int val = haveC ? to_int(v1) : 0;
+            appendInt(out, lc, 4);
+            out += "  +00 0 ";
+            appendInt(out, val, 4);
+            out += '\n';
+        }
+        return;
+    }
+
+    // Handle IS (imperatives) -> emit one machine instruction
+    if (k0 == "IS") {
+        int opcode = to_int(v0);
+        int reg = 0;       // default register/cc field
+        int addr = 0;      // default address/immediate
+
+        // Iterate over remaining tuples to fill reg/addr
+        for (string_view t; !(t = asmlex::nextToken(s, false)).empty(); ){
+            string_view k,v; if (!parse_tuple(t, k, v)) continue;
+            if (k=="R" || k=="CC") {
+                if (is_digits(v)) reg = to_int(v);
+            } else if (k=="C") {
+                if (is_digits(v)) addr = to_int(v);
+            } else if (k=="S") {
+                // Pass-I writes the symbol name: (S,NAME)
+                uint32_t id = ST.ids.find(v);
+                addr = (id != SymbolInterner::npos) ? ST.syms[id].addr : 0;
+            } else if (k=="L") {
+                // literal index (0-based)
+                int idx = is_digits(v) ? to_int(v) : -1;
+                if (idx>=0 && idx<(int)LT.size()) addr = LT[idx].addr;
+            }
+        }
+
+        appendInt(out, lc, 4);
+        out += "  +";
+        appendInt(out, opcode, 2);
+        out += ' ';
+        appendInt(out, reg);
+        out += ' ';
+        appendInt(out, addr, 4);
+        out += '\n';
+    }
+
+    // Unknown tuple class; skip
+}
+
 int main(int argc, char** argv){
     ios::sync_with_stdio(false);
     cin.tie(nullptr);
 
+    unsigned threads = 1;
+    bool collapse_ds = false;
+    for (int i=1; i<argc; ++i){
+        string a = argv[i];
+        if (a == "--threads" && i+1 < argc && atoi(argv[i+1]) >= 0) {
+            int n = atoi(argv[++i]);
+            threads = n ? (unsigned)n : max(1u, thread::hardware_concurrency());
+        } else if (a == "--collapse-ds") {
+            collapse_ds = true;
+        } else {
+            cerr << "Usage: " << argv[0] << " [--threads N] [--collapse-ds]\n";
+            return 2;
+        }
+    }
+
     // file names are fixed to match Pass-I outputs
     const string icFile  = "intermediate.txt";
     const string stFile  = "symbol_table.txt";
@@ -112,104 +244,38 @@ int main(int argc, char** argv){
     auto ST = load_symbols(stFile);
     auto LT = load_literals(ltFile);
 
-    ifstream ic(icFile);
-    if (!ic){ cerr << "Cannot open " << icFile << "\n"; return 1; }
+    MappedFile ic;
+    if (!ic.open(icFile)){ cerr << "Cannot open " << icFile << "\n"; return 1; }
     ofstream out(outFile);
     if (!out){ cerr << "Cannot create " << outFile << "\n"; return 1; }
 
-    string line;
-    while (getline(ic, line)){
-        string s = trim(line);
-        if (s.empty()) continue;
-
-        // Tokenize: first field may be LC or blank; then tuples
-        istringstream iss(s);
-        string first; iss >> first;
-
-        int lc = -1;
-        vector<string> tuples;
-
-        if (!first.empty() && is_digits(first)) {
-            lc = stoi(first);
-        } else {
-            // first wasn't LC; it's a tuple
-            tuples.push_back(first);
-        }
-        // read remaining tokens
-        string t;
-        while (iss >> t) tuples.push_back(t);
-
-        // Parse first tuple to know what this line is
-        if (tuples.empty()) continue;
-        string k0, v0;
-        if (!parse_tuple(tuples[0], k0, v0)) continue;
-
-        // Handle AD (assembler directives) -> no machine code
-        if (k0 == "AD") {
-            continue;
-        }
-
-        // Handle DL (declaratives)
-        if (k0 == "DL") {
-            if (v0 == "01") { // DS
-                // Expect (C,n) as next tuple
-                int n = 0;
-                if (tuples.size() >= 2) {
-                    string k1, v1; parse_tuple(tuples[1], k1, v1);
-                    if (k1=="C" && is_digits(v1)) n = stoi(v1);
-                }
-                for (int i=0;i<n;i++){
-                    out << setw(4) << setfill('0') << (lc+i) << "  "
-                        << "+00 0 0000\n";
-                }
-            } else if (v0 == "02") { // DC
-                // Expect (C,val)
-                int val = 0;
-                if (tuples.size() >= 2) {
-                    string k1, v1; parse_tuple(tuples[1], k1, v1);
-                    if (k1=="C" && is_digits(v1)) val = stoi(v1);
-                }
-                out << setw(4) << setfill('0') << lc << "  "
-                    << "+00 0 " << setw(4) << setfill('0') << val << "\n";
-            }
-            continue;
-        }
+    // Cut the file into ~1 MiB chunks that end on a line boundary
+    const size_t kChunkBytes = 1 << 20;
+    const char* text = ic.data();
+    const size_t size = ic.size();
+    vector<size_t> cuts{0};
+    while (cuts.back() < size){
+        size_t end = min(size, cuts.back() + kChunkBytes);
+        const void* nl = end < size ? memchr(text + end, '\n', size - end) : nullptr;
+        cuts.push_back(nl ? (size_t)(static_cast<const char*>(nl) - text) + 1 : size);
+    }
+    const size_t chunks = cuts.size() - 1;
 
-        // Handle IS (imperatives) -> emit one machine instruction
-        if (k0 == "IS") {
-            int opcode = stoi(v0);
-            int reg = 0;       // default register/cc field
-            int addr = 0;      // default address/immediate
-
-            // Iterate over remaining tuples to fill reg/addr
-            for (size_t i=1; i<tuples.size(); ++i){
-                string k,v; if (!parse_tuple(tuples[i], k, v)) continue;
-                if (k=="R" || k=="CC") {
-                    if (is_digits(v)) reg = stoi(v);
-                } else if (k=="C") {
-                    if (is_digits(v)) addr = stoi(v);
-                } else if (k=="S") {
-                    // Here Pass-I put symbol name directly: (S,NAME)
-                    // If your Pass-I encodes S as an index, adapt here.
-                    string name = v;
-                    if (ST.count(name)) addr = ST[name].addr;
-                    else addr = 0;
-                } else if (k=="L") {
-                    // literal index (0-based)
-                    int idx = is_digits(v) ? stoi(v) : -1;
-                    if (idx>=0 && idx<(int)LT.size()) addr = LT[idx].addr;
-                }
+    // Translate a wave of chunks in parallel, then write the buffers in order
+    ThreadPool pool(threads);
+    vector<string> buffers(min(chunks, (size_t)pool.size() * 4));
+    for (size_t first = 0; first < chunks; first += buffers.size()){
+        size_t wave = min(buffers.size(), chunks - first);
+        pool.parallelFor(wave, [&](size_t i){
+            string_view rest(text + cuts[first+i], cuts[first+i+1] - cuts[first+i]);
+            buffers[i].clear();
+            while (!rest.empty()){
+                size_t nl = rest.find('\n');
+                translate_line(rest.substr(0, nl), ST, LT, collapse_ds, buffers[i]);
+                rest.remove_prefix(nl == string_view::npos ? rest.size() : nl + 1);
             }
-
-            out << setw(4) << setfill('0') << lc << "  "
-                << "+" << setw(2) << setfill('0') << opcode
-                << " " << reg
-                << " " << setw(4) << setfill('0') << addr
-                << "\n";
-            continue;
-        }
-
-        // Unknown tuple class; skip
+        });
+        for (size_t i=0; i<wave; ++i) out.write(buffers[i].data(), (streamsize)buffers[i].size());
     }
 
     cout << "PASS-2 COMPLETED\nMachine code written to: " << outFile << "\n";